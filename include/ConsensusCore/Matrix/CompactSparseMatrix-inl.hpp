@@ -0,0 +1,216 @@
+#pragma once
+
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cstdint>
+#include <vector>
+
+#include <ConsensusCore/Interval.hpp>
+#include <ConsensusCore/Matrix/CompactSparseMatrix.hpp>
+
+namespace ConsensusCore {
+//
+// Nullability
+//
+template <typename F>
+inline const CompactSparseMatrix<F>& CompactSparseMatrix<F>::Null()
+{
+    static CompactSparseMatrix<F>* nullObj = new CompactSparseMatrix<F>(0, 0);
+    return *nullObj;
+}
+
+template <typename F>
+inline bool CompactSparseMatrix<F>::IsNull() const
+{
+    return (Rows() == 0 && Columns() == 0);
+}
+
+//
+// Size information
+//
+template <typename F>
+inline int CompactSparseMatrix<F>::Rows() const
+{
+    return rows_;
+}
+
+template <typename F>
+inline int CompactSparseMatrix<F>::Columns() const
+{
+    return usedRanges_.size();
+}
+
+//
+// Entry range queries per column
+//
+template <typename F>
+inline void CompactSparseMatrix<F>::StartEditingColumn(int j, int, int)
+{
+    assert(columnBeingEdited_ == -1);
+    assert(0 <= j && j < Columns());
+    columnBeingEdited_ = j;
+    ClearColumn(j);
+}
+
+template <typename F>
+inline void CompactSparseMatrix<F>::FinishEditingColumn(int j, int usedBegin, int usedEnd)
+{
+    assert(columnBeingEdited_ == j);
+    assert(0 <= usedBegin && usedBegin <= usedEnd && usedEnd <= Rows());
+    usedRanges_[j] = Interval(usedBegin, usedEnd);
+
+    // Rebase each block of the scratch column on its maximum, in place
+    float* values = scratch_.data();
+    std::vector<float>& bases = blockBases_[j];
+    bases.clear();
+    for (int begin = usedBegin; begin < usedEnd; begin = (begin & ~(BLOCK - 1)) + BLOCK) {
+        int end = std::min((begin & ~(BLOCK - 1)) + BLOCK, usedEnd);
+        float base = *std::max_element(values + begin, values + end);
+        base = (base == -FLT_MAX) ? 0.0f : base;
+        for (int i = begin; i < end; i++) {
+            values[i] -= base;
+        }
+        bases.push_back(base);
+    }
+    dirtyRows_ = RangeUnion(dirtyRows_, usedRanges_[j]);
+
+    values += usedBegin;
+    int n = usedEnd - usedBegin;
+    std::vector<uint16_t>& column = columns_[j];
+    column.resize(n);
+    int k = 0;
+    for (; k + 4 <= n; k += 4) {
+        __m128i h = F::Encode4(_mm_loadu_ps(values + k));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(&column[k]), h);
+    }
+    if (k < n) {
+        float tail[4] = {-FLT_MAX, -FLT_MAX, -FLT_MAX, -FLT_MAX};
+        std::copy(values + k, values + n, tail);
+        uint16_t encoded[8];
+        __m128i h = F::Encode4(_mm_loadu_ps(tail));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(encoded), h);
+        std::copy(encoded, encoded + (n - k), &column[k]);
+    }
+
+    // Leave the scratch buffer empty for the next column
+    if (dirtyRows_.Begin < dirtyRows_.End) {
+        std::fill(scratch_.begin() + dirtyRows_.Begin, scratch_.begin() + dirtyRows_.End, -FLT_MAX);
+    }
+    dirtyRows_ = Interval(Rows(), 0);
+    columnBeingEdited_ = -1;
+}
+
+template <typename F>
+inline Interval CompactSparseMatrix<F>::UsedRowRange(int j) const
+{
+    assert(0 <= j && j < Columns());
+    return usedRanges_[j];
+}
+
+template <typename F>
+inline bool CompactSparseMatrix<F>::IsColumnEmpty(int j) const
+{
+    assert(0 <= j && j < Columns());
+    return (usedRanges_[j].Begin >= usedRanges_[j].End);
+}
+
+//
+// Accessors
+//
+template <typename F>
+inline float CompactSparseMatrix<F>::operator()(int i, int j) const
+{
+    assert(0 <= j && j < Columns());
+    if (j == columnBeingEdited_) return (0 <= i && i < Rows()) ? scratch_[i] : -FLT_MAX;
+    const Interval& used = usedRanges_[j];
+    if (i < used.Begin || i >= used.End) return -FLT_MAX;
+    __m128i h = _mm_cvtsi32_si128(columns_[j][i - used.Begin]);
+    float base = blockBases_[j][i / BLOCK - used.Begin / BLOCK];
+    // Empty cells decode to -infinity
+    return std::max(_mm_cvtss_f32(F::Decode4(h)) + base, -FLT_MAX);
+}
+
+template <typename F>
+inline bool CompactSparseMatrix<F>::IsAllocated(int i, int j) const
+{
+    const Interval& used = usedRanges_[j];
+    return (used.Begin <= i && i < used.End);
+}
+
+template <typename F>
+inline float CompactSparseMatrix<F>::Get(int i, int j) const
+{
+    return (*this)(i, j);
+}
+
+template <typename F>
+inline void CompactSparseMatrix<F>::Set(int i, int
+#ifndef NDEBUG
+                                                   j
+#endif
+                                        ,
+                                        float v)
+{
+    assert(columnBeingEdited_ == j);
+    assert(0 <= i && i < Rows());
+    scratch_[i] = v;
+    dirtyRows_ = RangeUnion(dirtyRows_, Interval(i, i + 1));
+}
+
+template <typename F>
+inline void CompactSparseMatrix<F>::ClearColumn(int j)
+{
+    usedRanges_[j] = Interval(0, 0);
+    blockBases_[j].clear();
+    columns_[j].clear();
+}
+
+//
+// SSE
+//
+template <typename F>
+inline __m128 CompactSparseMatrix<F>::Get4(int i, int j) const
+{
+    if (j == columnBeingEdited_) {
+        return _mm_setr_ps(Get(i, j), Get(i + 1, j), Get(i + 2, j), Get(i + 3, j));
+    }
+    return Decode4(i, j);
+}
+
+template <typename F>
+inline void CompactSparseMatrix<F>::Set4(int i, int
+#ifndef NDEBUG
+                                                    j
+#endif
+                                         ,
+                                         __m128 v)
+{
+    assert(columnBeingEdited_ == j);
+    assert(0 <= i && i + 4 <= Rows());
+    _mm_storeu_ps(&scratch_[i], v);
+    dirtyRows_ = RangeUnion(dirtyRows_, Interval(i, i + 4));
+}
+
+template <typename F>
+inline __m128 CompactSparseMatrix<F>::Decode4(int i, int j) const
+{
+    const Interval& used = usedRanges_[j];
+    if (used.Begin <= i && i + 4 <= used.End) {
+        __m128i h = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(&columns_[j][i - used.Begin]));
+        // The four rows straddle two blocks unless i is block-aligned
+        const float* bases = &blockBases_[j][i / BLOCK - used.Begin / BLOCK];
+        int inFirst = BLOCK - i % BLOCK;
+        __m128 first = _mm_cmplt_ps(_mm_setr_ps(0, 1, 2, 3), _mm_set1_ps(inFirst));
+        __m128 second = _mm_set1_ps(inFirst < BLOCK ? bases[1] : bases[0]);
+        __m128 base4 =
+            _mm_or_ps(_mm_and_ps(first, _mm_set1_ps(bases[0])), _mm_andnot_ps(first, second));
+        __m128 v = _mm_add_ps(F::Decode4(h), base4);
+        return _mm_max_ps(v, _mm_set1_ps(-FLT_MAX));
+    }
+    return _mm_setr_ps(Get(i, j), Get(i + 1, j), Get(i + 2, j), Get(i + 3, j));
+}
+}
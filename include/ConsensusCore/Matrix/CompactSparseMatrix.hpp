@@ -0,0 +1,89 @@
+#pragma once
+
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <ConsensusCore/Interval.hpp>
+#include <ConsensusCore/Matrix/AbstractMatrix.hpp>
+#include <ConsensusCore/Matrix/HalfFloat.hpp>
+#include <ConsensusCore/Types.hpp>
+#include <ConsensusCore/Utils.hpp>
+
+namespace ConsensusCore {
+
+/// \brief A banded matrix like SparseMatrix whose entries are stored as
+/// 16-bit floats (format F, e.g. HalfFormat), at three
+/// quarters of the memory.  Reads and writes are in float.
+///
+/// Each block of BLOCK rows (aligned to multiples of BLOCK) stores its
+/// entries relative to its own maximum (its base, kept as a float), so the
+/// 16-bit values only span the few score units between neighbouring rows
+/// rather than a whole read's worth of log-probability, or the whole band.
+/// Block maxima are therefore exact and other entries carry the format's
+/// relative rounding error on their distance below them.  A column being edited lives in a full-height
+/// float scratch buffer, which reads of that column go to; it is encoded
+/// when it is finished.
+template <typename F>
+class CompactSparseMatrix : public AbstractMatrix
+{
+public:
+    static const int BLOCK = 4;
+
+public:  // Constructor, destructor
+    CompactSparseMatrix(int rows, int cols);
+    CompactSparseMatrix(const CompactSparseMatrix& other);
+    ~CompactSparseMatrix();
+
+public:  // Nullability
+    static const CompactSparseMatrix& Null();
+    bool IsNull() const;
+
+public:  // Size information
+    int Rows() const;
+    int Columns() const;
+
+public:  // Information about entries filled by column
+    void StartEditingColumn(int j, int hintBegin, int hintEnd);
+    void FinishEditingColumn(int j, int usedBegin, int usedEnd);
+    Interval UsedRowRange(int j) const;
+    bool IsColumnEmpty(int j) const;
+    int UsedEntries() const;
+    int AllocatedEntries() const;  // 16-bit entries and block bases, plus the scratch column
+
+public:  // Accessors
+    float operator()(int i, int j) const;
+    bool IsAllocated(int i, int j) const;
+    float Get(int i, int j) const;
+    void Set(int i, int j, float v);
+    void ClearColumn(int j);
+
+public:  // SSE accessors, which access 4 successive entries in a column
+    __m128 Get4(int i, int j) const;
+    void Set4(int i, int j, __m128 v);
+
+public:
+    // Method SWIG clients can use to get a native matrix (e.g. Numpy)
+    // mat must be filled as a ROW major matrix
+    void ToHostMatrix(float** mat, int* rows, int* cols) const;
+
+private:
+    // Entries i .. i + 3 of a finished column; -FLT_MAX outside its used range
+    __m128 Decode4(int i, int j) const;
+
+private:
+    int rows_;
+    std::vector<Interval> usedRanges_;
+    std::vector<std::vector<float> > blockBases_;
+    std::vector<std::vector<uint16_t> > columns_;
+    std::vector<float> scratch_;
+    int columnBeingEdited_;
+    Interval dirtyRows_;
+};
+
+typedef CompactSparseMatrix<HalfFormat> HalfSparseMatrix;
+}
+
+#include <ConsensusCore/Matrix/CompactSparseMatrix-inl.hpp>
@@ -121,4 +121,35 @@ inline void DenseMatrix::Set4(int i, int j, __m128 v4)
     assert(0 <= i && i <= Rows() - 4);
     _mm_storeu_ps(&boost_dense_matrix::operator()(i, j).value, v4);
 }
+
+#ifdef CC_SIMD_DISPATCH
+//
+// AVX2 and AVX-512
+//
+inline __m256 DenseMatrix::Get8(int i, int j) const
+{
+    assert(0 <= i && i <= Rows() - 8);
+    return _mm256_loadu_ps(&boost_dense_matrix::operator()(i, j).value);
+}
+
+inline void DenseMatrix::Set8(int i, int j, __m256 v8)
+{
+    assert(columnBeingEdited_ == j);
+    assert(0 <= i && i <= Rows() - 8);
+    _mm256_storeu_ps(&boost_dense_matrix::operator()(i, j).value, v8);
+}
+
+inline __m512 DenseMatrix::Get16(int i, int j) const
+{
+    assert(0 <= i && i <= Rows() - 16);
+    return _mm512_loadu_ps(&boost_dense_matrix::operator()(i, j).value);
+}
+
+inline void DenseMatrix::Set16(int i, int j, __m512 v16)
+{
+    assert(columnBeingEdited_ == j);
+    assert(0 <= i && i <= Rows() - 16);
+    _mm512_storeu_ps(&boost_dense_matrix::operator()(i, j).value, v16);
+}
+#endif  // CC_SIMD_DISPATCH
 }
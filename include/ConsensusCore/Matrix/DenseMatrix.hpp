@@ -11,6 +11,7 @@
 #include <ConsensusCore/Interval.hpp>
 #include <ConsensusCore/LFloat.hpp>
 #include <ConsensusCore/Matrix/AbstractMatrix.hpp>
+#include <ConsensusCore/SimdTarget.hpp>
 #include <ConsensusCore/Types.hpp>
 #include <ConsensusCore/Utils.hpp>
 
@@ -67,6 +68,14 @@ public:  // SSE accessors, which access 4 successive entries in a column
     __m128 Get4(int i, int j) const;
     void Set4(int i, int j, __m128 v);
 
+#ifdef CC_SIMD_DISPATCH
+public:  // AVX2 and AVX-512 accessors, for 8 and 16 successive entries
+    CC_TARGET_AVX2 __m256 Get8(int i, int j) const;
+    CC_TARGET_AVX2 void Set8(int i, int j, __m256 v);
+    CC_TARGET_AVX512 __m512 Get16(int i, int j) const;
+    CC_TARGET_AVX512 void Set16(int i, int j, __m512 v);
+#endif  // CC_SIMD_DISPATCH
+
 public:
     // Method SWIG clients can use to get a native matrix (e.g. Numpy)
     // mat must be filled as a ROW major matrix
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+#include <cstdint>
+
+namespace ConsensusCore {
+
+// 16-bit float storage formats for CompactSparseMatrix.  Each converts four
+// floats at a time to and from four 16-bit words held in the low half of an
+// SSE2 integer register, rounding to nearest even.  Infinities are kept;
+// NaNs are never stored and are not handled.
+
+/// \brief IEEE 754 half precision: 11 significant bits, magnitudes up to
+/// 65504; larger magnitudes become infinities.
+struct HalfFormat
+{
+    static __m128i Encode4(__m128 v)
+    {
+        __m128i u = _mm_castps_si128(v);
+        __m128i sign = _mm_and_si128(u, _mm_set1_epi32(INT32_MIN));
+        u = _mm_xor_si128(u, sign);
+
+        // Half subnormals: let the float adder do the rounding
+        __m128 subnormalMagic = _mm_castsi128_ps(_mm_set1_epi32(126 << 23));
+        __m128i subnormal =
+            _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(u), subnormalMagic)),
+                          _mm_castps_si128(subnormalMagic));
+
+        // Normal numbers: rebias the exponent and round the mantissa
+        __m128i mantissaOdd = _mm_and_si128(_mm_srli_epi32(u, 13), _mm_set1_epi32(1));
+        __m128i normal = _mm_add_epi32(u, _mm_set1_epi32(-(112 << 23) + 0xfff));
+        normal = _mm_srli_epi32(_mm_add_epi32(normal, mantissaOdd), 13);
+
+        __m128i isSubnormal = _mm_cmplt_epi32(u, _mm_set1_epi32(113 << 23));
+        __m128i isInfinite = _mm_cmpgt_epi32(u, _mm_set1_epi32((143 << 23) - 1));
+        __m128i h = Select(isSubnormal, subnormal, normal);
+        h = Select(isInfinite, _mm_set1_epi32(0x7c00), h);
+        h = _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+        return Pack(h);
+    }
+
+    static __m128 Decode4(__m128i h)
+    {
+        h = _mm_unpacklo_epi16(h, _mm_setzero_si128());
+        __m128i shiftedExponent = _mm_set1_epi32(0x7c00 << 13);
+        __m128i u = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x7fff)), 13);
+        __m128i exponent = _mm_and_si128(u, shiftedExponent);
+        u = _mm_add_epi32(u, _mm_set1_epi32(112 << 23));
+
+        // Infinities take the largest float exponent
+        __m128i isInfinite = _mm_cmpeq_epi32(exponent, shiftedExponent);
+        u = _mm_add_epi32(u, _mm_and_si128(isInfinite, _mm_set1_epi32(112 << 23)));
+
+        // Zeros and subnormals are renormalized by a float subtraction
+        __m128 subnormalMagic = _mm_castsi128_ps(_mm_set1_epi32(113 << 23));
+        __m128i subnormal = _mm_castps_si128(_mm_sub_ps(
+            _mm_castsi128_ps(_mm_add_epi32(u, _mm_set1_epi32(1 << 23))), subnormalMagic));
+        __m128i isSubnormal = _mm_cmpeq_epi32(exponent, _mm_setzero_si128());
+        u = Select(isSubnormal, subnormal, u);
+
+        __m128i sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+        return _mm_castsi128_ps(_mm_or_si128(u, sign));
+    }
+
+private:
+    static __m128i Select(__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+
+    // Narrow four 16-bit values held in 32-bit lanes
+    static __m128i Pack(__m128i h)
+    {
+        h = _mm_srai_epi32(_mm_slli_epi32(h, 16), 16);
+        return _mm_packs_epi32(h, h);
+    }
+};
+}
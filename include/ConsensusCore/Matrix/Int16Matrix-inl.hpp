@@ -0,0 +1,194 @@
+#pragma once
+
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cstdint>
+
+#include <ConsensusCore/Interval.hpp>
+#include <ConsensusCore/Matrix/Int16Matrix.hpp>
+
+namespace ConsensusCore {
+//
+// Nullability
+//
+inline const Int16Matrix& Int16Matrix::Null()
+{
+    static Int16Matrix* nullObj = new Int16Matrix(0, 0);
+    return *nullObj;
+}
+
+inline bool Int16Matrix::IsNull() const { return (Rows() == 0 && Columns() == 0); }
+
+//
+// Size information
+//
+inline int Int16Matrix::Rows() const { return rows_; }
+
+inline int Int16Matrix::Columns() const { return usedRanges_.size(); }
+
+//
+// Entry range queries per column
+//
+inline void Int16Matrix::StartEditingColumn(int j, int, int)
+{
+    assert(columnBeingEdited_ == -1);
+    assert(0 <= j && j < Columns());
+    columnBeingEdited_ = j;
+    ClearColumn(j);
+}
+
+inline void Int16Matrix::FinishEditingColumn(int j, int usedBegin, int usedEnd)
+{
+    assert(columnBeingEdited_ == j);
+    assert(0 <= usedBegin && usedBegin <= usedEnd && usedEnd <= Rows());
+    usedRanges_[j] = Interval(usedBegin, usedEnd);
+    floats_[j].assign(scratch_.begin() + usedBegin, scratch_.begin() + usedEnd);
+    // Leave the scratch buffer empty for the next column
+    if (dirtyRows_.Begin < dirtyRows_.End) {
+        std::fill(scratch_.begin() + dirtyRows_.Begin, scratch_.begin() + dirtyRows_.End, -FLT_MAX);
+    }
+    dirtyRows_ = Interval(Rows(), 0);
+    columnBeingEdited_ = -1;
+}
+
+inline Interval Int16Matrix::UsedRowRange(int j) const
+{
+    assert(0 <= j && j < Columns());
+    return usedRanges_[j];
+}
+
+inline bool Int16Matrix::IsColumnEmpty(int j) const
+{
+    assert(0 <= j && j < Columns());
+    return (usedRanges_[j].Begin >= usedRanges_[j].End);
+}
+
+//
+// Accessors
+//
+inline float Int16Matrix::operator()(int i, int j) const
+{
+    assert(0 <= j && j < Columns());
+    if (j == columnBeingEdited_) return (0 <= i && i < Rows()) ? scratch_[i] : -FLT_MAX;
+    const Interval& used = usedRanges_[j];
+    if (i < used.Begin || i >= used.End) return -FLT_MAX;
+    if (!IsQuantized(j)) return floats_[j][i - used.Begin];
+    int16_t q = quantized_[j][i - used.Begin];
+    if (q == EMPTY_CELL) return -FLT_MAX;
+    return static_cast<float>(bases_[j] + q) * quanta_[j];
+}
+
+inline bool Int16Matrix::IsAllocated(int i, int j) const
+{
+    const Interval& used = usedRanges_[j];
+    return (used.Begin <= i && i < used.End);
+}
+
+inline float Int16Matrix::Get(int i, int j) const { return (*this)(i, j); }
+
+inline void Int16Matrix::Set(int i, int
+#ifndef NDEBUG
+                                        j
+#endif
+                             ,
+                             float v)
+{
+    assert(columnBeingEdited_ == j);
+    assert(0 <= i && i < Rows());
+    scratch_[i] = v;
+    dirtyRows_ = RangeUnion(dirtyRows_, Interval(i, i + 1));
+}
+
+inline void Int16Matrix::ClearColumn(int j)
+{
+    usedRanges_[j] = Interval(0, 0);
+    bases_[j] = 0;
+    quanta_[j] = 1.0f;
+    isQuantized_[j] = false;
+    quantized_[j].clear();
+    floats_[j].clear();
+}
+
+//
+// SSE
+//
+inline __m128 Int16Matrix::Get4(int i, int j) const
+{
+    const Interval& used = usedRanges_[j];
+    if (j != columnBeingEdited_ && !IsQuantized(j) && used.Begin <= i && i + 4 <= used.End) {
+        return _mm_loadu_ps(&floats_[j][i - used.Begin]);
+    }
+    return _mm_setr_ps(Get(i, j), Get(i + 1, j), Get(i + 2, j), Get(i + 3, j));
+}
+
+inline void Int16Matrix::Set4(int i, int
+#ifndef NDEBUG
+                                         j
+#endif
+                              ,
+                              __m128 v)
+{
+    assert(columnBeingEdited_ == j);
+    assert(0 <= i && i + 4 <= Rows());
+    _mm_storeu_ps(&scratch_[i], v);
+    dirtyRows_ = RangeUnion(dirtyRows_, Interval(i, i + 4));
+}
+
+//
+// Fixed point
+//
+inline bool Int16Matrix::IsQuantized(int j) const { return isQuantized_[j]; }
+
+inline int Int16Matrix::Scale(int j) const
+{
+    assert(IsQuantized(j));
+    return static_cast<int>(1.0f / quanta_[j] + 0.5f);
+}
+
+inline int Int16Matrix::Base(int j) const
+{
+    assert(IsQuantized(j));
+    return bases_[j];
+}
+
+inline int16_t Int16Matrix::GetQuantized(int i, int j) const
+{
+    assert(IsQuantized(j));
+    const Interval& used = usedRanges_[j];
+    if (i < used.Begin || i >= used.End) return EMPTY_CELL;
+    return quantized_[j][i - used.Begin];
+}
+
+inline __m128i Int16Matrix::GetQuantized8(int i, int j) const
+{
+    assert(IsQuantized(j));
+    const Interval& used = usedRanges_[j];
+    const int16_t* column = quantized_[j].data() - used.Begin;
+    if (used.Begin <= i && i + 8 <= used.End) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(column + i));
+    }
+    int16_t q[8];
+    for (int k = 0; k < 8; k++) {
+        q[k] = (used.Begin <= i + k && i + k < used.End) ? column[i + k] : EMPTY_CELL;
+    }
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(q));
+}
+
+inline void Int16Matrix::SetQuantizedColumn(int j, int scale, int base, int usedBegin, int usedEnd,
+                                            const int16_t* values)
+{
+    assert(columnBeingEdited_ == -1);
+    assert(0 <= usedBegin && usedBegin <= usedEnd && usedEnd <= Rows());
+    assert(MIN_SCALE <= scale && scale <= SCALE);
+    ClearColumn(j);
+    usedRanges_[j] = Interval(usedBegin, usedEnd);
+    bases_[j] = base;
+    quanta_[j] = 1.0f / scale;
+    isQuantized_[j] = true;
+    quantized_[j].assign(values, values + (usedEnd - usedBegin));
+}
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <emmintrin.h>
+#include <xmmintrin.h>
+
+#include <cstdint>
+#include <vector>
+
+#include <ConsensusCore/Interval.hpp>
+#include <ConsensusCore/Matrix/AbstractMatrix.hpp>
+#include <ConsensusCore/Types.hpp>
+#include <ConsensusCore/Utils.hpp>
+
+namespace ConsensusCore {
+
+/// \brief A banded matrix whose columns are stored either as 16-bit fixed
+/// point or as plain floats.
+///
+/// A quantized column holds, for each used row, an int16 offset from the
+/// column's base, in units of 1/scale; an entry reads as
+/// (base + q) / scale, or -FLT_MAX if q is EMPTY_CELL.  The scale is the
+/// column's own, so that wide bands can trade precision for range (see
+/// ScaleFor).  Quantized columns are written whole by the int16 recursor
+/// (SetQuantizedColumn) and take half the space of float columns.
+///
+/// Columns written through the float interface (StartEditingColumn, Set,
+/// Set4, FinishEditingColumn) are stored as floats, so fills that cannot be
+/// quantized, and the extension buffers of the mutation scorers, stay
+/// exact.  While a column is being edited it lives in a full-height scratch
+/// buffer, which reads of that column go to.
+class Int16Matrix : public AbstractMatrix
+{
+public:
+    /// Quanta per unit of score, at the finest scale
+    static const int SCALE = 128;
+    /// The coarsest scale a band is quantized at
+    static const int MIN_SCALE = 32;
+    /// Quantized value of an empty (-FLT_MAX) cell
+    static const int16_t EMPTY_CELL = INT16_MIN;
+    /// The lowest quantized value a non-empty cell may take, relative to
+    /// its column's base
+    static const int16_t FLOOR = -16384;
+
+    /// The finest scale, from SCALE down to MIN_SCALE, at which a band of
+    /// scoreDiff fits above FLOOR with room left for a column's maximum to
+    /// drop below its predecessor's; 0 if none does.
+    static int ScaleFor(float scoreDiff);
+
+public:  // Constructor, destructor
+    Int16Matrix(int rows, int cols);
+    Int16Matrix(const Int16Matrix& other);
+    ~Int16Matrix();
+
+public:  // Nullability
+    static const Int16Matrix& Null();
+    bool IsNull() const;
+
+public:  // Size information
+    int Rows() const;
+    int Columns() const;
+
+public:  // Information about entries filled by column
+    void StartEditingColumn(int j, int hintBegin, int hintEnd);
+    void FinishEditingColumn(int j, int usedBegin, int usedEnd);
+    Interval UsedRowRange(int j) const;
+    bool IsColumnEmpty(int j) const;
+    int UsedEntries() const;
+    int AllocatedEntries() const;
+
+public:  // Accessors
+    float operator()(int i, int j) const;
+    bool IsAllocated(int i, int j) const;
+    float Get(int i, int j) const;
+    void Set(int i, int j, float v);
+    void ClearColumn(int j);
+
+public:  // SSE accessors, which access 4 successive entries in a column
+    __m128 Get4(int i, int j) const;
+    void Set4(int i, int j, __m128 v);
+
+public:  // Fixed-point access, for the int16 recursor
+    bool IsQuantized(int j) const;
+    /// Quanta per unit of score of a quantized column
+    int Scale(int j) const;
+    /// The base of a quantized column, in quanta
+    int Base(int j) const;
+    /// Quantized entry (i, j), relative to the column's base
+    int16_t GetQuantized(int i, int j) const;
+    /// Quantized entries i .. i + 7 of a quantized column, relative to its
+    /// base; EMPTY_CELL outside the used range.
+    __m128i GetQuantized8(int i, int j) const;
+    /// Store a whole quantized column; values[0] is row usedBegin.
+    void SetQuantizedColumn(int j, int scale, int base, int usedBegin, int usedEnd,
+                            const int16_t* values);
+
+public:
+    // Method SWIG clients can use to get a native matrix (e.g. Numpy)
+    // mat must be filled as a ROW major matrix
+    void ToHostMatrix(float** mat, int* rows, int* cols) const;
+
+private:
+    int rows_;
+    std::vector<Interval> usedRanges_;
+    std::vector<int> bases_;
+    std::vector<float> quanta_;
+    std::vector<bool> isQuantized_;
+    std::vector<std::vector<int16_t> > quantized_;
+    std::vector<std::vector<float> > floats_;
+    std::vector<float> scratch_;
+    int columnBeingEdited_;
+    Interval dirtyRows_;
+};
+}
+
+#include <ConsensusCore/Matrix/Int16Matrix-inl.hpp>
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <xmmintrin.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+
+#include <ConsensusCore/Interval.hpp>
+#include <ConsensusCore/Matrix/InterleavedMatrix.hpp>
+
+namespace ConsensusCore {
+//
+// Nullability
+//
+inline const InterleavedMatrix& InterleavedMatrix::Null()
+{
+    static InterleavedMatrix* nullObj = new InterleavedMatrix(0, 0);
+    return *nullObj;
+}
+
+inline bool InterleavedMatrix::IsNull() const { return (Rows() == 0 && Columns() == 0); }
+
+//
+// Size information
+//
+inline int InterleavedMatrix::Rows() const { return rows_; }
+
+inline int InterleavedMatrix::Columns() const { return usedRanges_.size(); }
+
+//
+// Entry range queries per column
+//
+inline void InterleavedMatrix::StartEditingColumn(int j, int, int)
+{
+    assert(columnBeingEdited_ == -1);
+    assert(0 <= j && j < Columns());
+    columnBeingEdited_ = j;
+    ClearColumn(j);
+}
+
+inline void InterleavedMatrix::FinishEditingColumn(int j, int usedBegin, int usedEnd)
+{
+    assert(columnBeingEdited_ == j);
+    assert(0 <= usedBegin && usedBegin <= usedEnd && usedEnd <= Rows());
+    usedRanges_[j] = Interval(usedBegin, usedEnd);
+    columns_[j].assign(scratch_.begin() + LANES * usedBegin, scratch_.begin() + LANES * usedEnd);
+    columnBeingEdited_ = -1;
+}
+
+inline Interval InterleavedMatrix::UsedRowRange(int j) const
+{
+    assert(0 <= j && j < Columns());
+    return usedRanges_[j];
+}
+
+inline bool InterleavedMatrix::IsColumnEmpty(int j) const
+{
+    assert(0 <= j && j < Columns());
+    return (usedRanges_[j].Begin >= usedRanges_[j].End);
+}
+
+//
+// Accessors
+//
+inline float InterleavedMatrix::Get(int i, int j, int lane) const
+{
+    assert(0 <= lane && lane < LANES);
+    assert(columnBeingEdited_ != j);
+    const Interval& used = usedRanges_[j];
+    if (i < used.Begin || i >= used.End) return -FLT_MAX;
+    return columns_[j][LANES * (i - used.Begin) + lane];
+}
+
+inline __m128 InterleavedMatrix::Get4(int i, int j) const
+{
+    assert(0 <= i && i < Rows());
+    assert(columnBeingEdited_ != j);
+    const Interval& used = usedRanges_[j];
+    if (i < used.Begin || i >= used.End) return _mm_set_ps1(-FLT_MAX);
+    return _mm_loadu_ps(&columns_[j][LANES * (i - used.Begin)]);
+}
+
+inline void InterleavedMatrix::Set4(int i, int
+#ifndef NDEBUG
+                                               j
+#endif
+                                    ,
+                                    __m128 v)
+{
+    assert(columnBeingEdited_ == j);
+    assert(0 <= i && i < Rows());
+    _mm_storeu_ps(&scratch_[LANES * i], v);
+}
+
+inline void InterleavedMatrix::ClearColumn(int j)
+{
+    usedRanges_[j] = Interval(0, 0);
+    columns_[j].clear();
+}
+
+//
+// Conversion
+//
+template <typename M>
+inline void InterleavedMatrix::CopyLane(int lane, float scoreDiff, M& out) const
+{
+    assert(0 <= lane && lane < LANES);
+    assert(columnBeingEdited_ == -1);
+    assert(out.Rows() <= Rows() && out.Columns() <= Columns());
+    for (int j = 0; j < out.Columns(); j++) {
+        const Interval& used = usedRanges_[j];
+        const float* column = columns_[j].empty() ? NULL : &columns_[j][lane] - LANES * used.Begin;
+        int beginRow = used.Begin;
+        int endRow = std::min(used.End, out.Rows());
+
+        float maxScore = -FLT_MAX;
+        for (int i = beginRow; i < endRow; i++) {
+            maxScore = std::max(maxScore, column[LANES * i]);
+        }
+        float thresholdScore = maxScore - scoreDiff;
+        for (; beginRow < endRow && column[LANES * beginRow] < thresholdScore; beginRow++)
+            ;
+        for (; endRow > beginRow && column[LANES * (endRow - 1)] < thresholdScore; endRow--)
+            ;
+
+        out.StartEditingColumn(j, beginRow, endRow);
+        for (int i = beginRow; i < endRow; i++) {
+            out.Set(i, j, column[LANES * i]);
+        }
+        out.FinishEditingColumn(j, beginRow, endRow);
+    }
+}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <xmmintrin.h>
+
+#include <vector>
+
+#include <ConsensusCore/Interval.hpp>
+#include <ConsensusCore/Types.hpp>
+#include <ConsensusCore/Utils.hpp>
+
+namespace ConsensusCore {
+
+/// \brief A banded matrix holding four independent matrices interleaved
+/// cell by cell, so that entry (i, j) of every lane is one __m128.
+///
+/// Used by the batched recursors, which fill one read per lane.  Each column stores only its used row range (the union
+/// over lanes); entries outside it read as -FLT_MAX.  A column is written
+/// into a full-height scratch buffer while it is being edited and copied
+/// out when editing finishes, so a column being edited cannot be read.
+class InterleavedMatrix
+{
+public:
+    static const int LANES = 4;
+
+public:  // Constructor, destructor
+    InterleavedMatrix(int rows, int cols);
+    ~InterleavedMatrix();
+
+public:  // Nullability
+    static const InterleavedMatrix& Null();
+    bool IsNull() const;
+
+public:  // Size information
+    int Rows() const;
+    int Columns() const;
+
+public:  // Information about entries filled by column
+    void StartEditingColumn(int j, int hintBegin, int hintEnd);
+    void FinishEditingColumn(int j, int usedBegin, int usedEnd);
+    Interval UsedRowRange(int j) const;
+    bool IsColumnEmpty(int j) const;
+    int UsedEntries() const;
+    int AllocatedEntries() const;
+
+public:  // Accessors
+    /// Entry (i, j) of one lane
+    float Get(int i, int j, int lane) const;
+    /// Entry (i, j) of every lane; only finished columns may be read.
+    __m128 Get4(int i, int j) const;
+    void Set4(int i, int j, __m128 v);
+    void ClearColumn(int j);
+
+public:  // Conversion
+    /// \brief Copy one lane into an ordinary banded matrix of its read's
+    /// size, trimming each column to the lane's own band: the rows within
+    /// scoreDiff of the lane's best score in that column.
+    template <typename M>
+    void CopyLane(int lane, float scoreDiff, M& out) const;
+
+private:
+    int rows_;
+    std::vector<Interval> usedRanges_;
+    std::vector<std::vector<float> > columns_;
+    std::vector<float> scratch_;
+    int columnBeingEdited_;
+};
+}
+
+#include <ConsensusCore/Matrix/InterleavedMatrix-inl.hpp>
@@ -38,12 +38,9 @@ inline int SparseMatrix::Columns() const { return nCols_; }
 inline void SparseMatrix::StartEditingColumn(int j, int hintBegin, int hintEnd)
 {
     assert(columnBeingEdited_ == -1);
+    assert(hintBegin >= 0 && hintBegin <= hintEnd && hintEnd <= nRows_);
     columnBeingEdited_ = j;
-    if (columns_[j] != NULL) {
-        columns_[j]->ResetForRange(hintBegin, hintEnd);
-    } else {
-        columns_[j] = new SparseVector(Rows(), hintBegin, hintEnd);
-    }
+    AllocateColumn(j, max(hintBegin - COLUMN_PADDING, 0), min(hintEnd + COLUMN_PADDING, nRows_));
 }
 
 inline void SparseMatrix::FinishEditingColumn(int j, int usedRowsBegin, int usedRowsEnd)
@@ -72,16 +69,18 @@ inline bool SparseMatrix::IsColumnEmpty(int j) const
 inline const float& SparseMatrix::operator()(int i, int j) const
 {
     static const float emptyCell = Zero<lfloat>();
-    if (columns_[j] == NULL) {
-        return emptyCell;
+    const ColumnBand& band = bands_[j];
+    if (band.BeginRow <= i && i < band.EndRow) {
+        return slab_[band.Offset + i - band.BeginRow];
     } else {
-        return (*columns_[j])(i);
+        return emptyCell;
     }
 }
 
 inline bool SparseMatrix::IsAllocated(int i, int j) const
 {
-    return columns_[j] != NULL && columns_[j]->IsAllocated(i);
+    const ColumnBand& band = bands_[j];
+    return band.BeginRow <= i && i < band.EndRow;
 }
 
 inline float SparseMatrix::Get(int i, int j) const { return (*this)(i, j); }
@@ -89,13 +88,26 @@ inline float SparseMatrix::Get(int i, int j) const { return (*this)(i, j); }
 inline void SparseMatrix::Set(int i, int j, float v)
 {
     assert(columnBeingEdited_ == j);
-    columns_[j]->Set(i, v);
+    assert(0 <= i && i < nRows_);
+    ColumnBand& band = bands_[j];
+    if (!(band.BeginRow <= i && i < band.EndRow)) {
+        int beginRow = max(i - COLUMN_PADDING, 0);
+        int endRow = min(i + COLUMN_PADDING, nRows_);
+        if (band.BeginRow < band.EndRow) {
+            beginRow = min(beginRow, band.BeginRow);
+            endRow = max(endRow, band.EndRow);
+        }
+        ExpandColumn(j, beginRow, endRow);
+    }
+    slab_[band.Offset + i - band.BeginRow] = v;
 }
 
 inline void SparseMatrix::ClearColumn(int j)
 {
     usedRanges_[j] = Interval(0, 0);
-    columns_[j]->Clear();
+    const ColumnBand& band = bands_[j];
+    std::fill(slab_.begin() + band.Offset,
+              slab_.begin() + band.Offset + (band.EndRow - band.BeginRow), Zero<lfloat>());
     DEBUG_ONLY(CheckInvariants(j);)
 }
 
@@ -104,16 +116,78 @@ inline void SparseMatrix::ClearColumn(int j)
 //
 inline __m128 SparseMatrix::Get4(int i, int j) const
 {
-    if (columns_[j] == NULL) {
-        return Zero4<lfloat>();
+    const ColumnBand& band = bands_[j];
+    if (band.BeginRow <= i && i + 4 <= band.EndRow) {
+        return _mm_loadu_ps(&slab_[band.Offset + i - band.BeginRow]);
     } else {
-        return columns_[j]->Get4(i);
+        return Gather4(i, j);
     }
 }
 
 inline void SparseMatrix::Set4(int i, int j, __m128 v4)
 {
     assert(columnBeingEdited_ == j);
-    columns_[j]->Set4(i, v4);
+    const ColumnBand& band = bands_[j];
+    if (band.BeginRow <= i && i + 4 <= band.EndRow) {
+        _mm_storeu_ps(&slab_[band.Offset + i - band.BeginRow], v4);
+    } else {
+        Scatter4(i, j, v4);
+    }
+}
+
+#ifdef CC_SIMD_DISPATCH
+//
+// AVX2 and AVX-512: one load or store inside the band, and the four-wide
+// accessors across its edges
+//
+inline __m256 SparseMatrix::Get8(int i, int j) const
+{
+    const ColumnBand& band = bands_[j];
+    if (band.BeginRow <= i && i + 8 <= band.EndRow) {
+        return _mm256_loadu_ps(&slab_[band.Offset + i - band.BeginRow]);
+    } else {
+        return _mm256_set_m128(Get4(i + 4, j), Get4(i, j));
+    }
+}
+
+inline void SparseMatrix::Set8(int i, int j, __m256 v8)
+{
+    assert(columnBeingEdited_ == j);
+    const ColumnBand& band = bands_[j];
+    if (band.BeginRow <= i && i + 8 <= band.EndRow) {
+        _mm256_storeu_ps(&slab_[band.Offset + i - band.BeginRow], v8);
+    } else {
+        Set4(i, j, _mm256_castps256_ps128(v8));
+        Set4(i + 4, j, _mm256_extractf128_ps(v8, 1));
+    }
+}
+
+inline __m512 SparseMatrix::Get16(int i, int j) const
+{
+    const ColumnBand& band = bands_[j];
+    if (band.BeginRow <= i && i + 16 <= band.EndRow) {
+        return _mm512_loadu_ps(&slab_[band.Offset + i - band.BeginRow]);
+    } else {
+        __m512 v16 = _mm512_setzero_ps();
+        v16 = _mm512_insertf32x4(v16, Get4(i, j), 0);
+        v16 = _mm512_insertf32x4(v16, Get4(i + 4, j), 1);
+        v16 = _mm512_insertf32x4(v16, Get4(i + 8, j), 2);
+        return _mm512_insertf32x4(v16, Get4(i + 12, j), 3);
+    }
+}
+
+inline void SparseMatrix::Set16(int i, int j, __m512 v16)
+{
+    assert(columnBeingEdited_ == j);
+    const ColumnBand& band = bands_[j];
+    if (band.BeginRow <= i && i + 16 <= band.EndRow) {
+        _mm512_storeu_ps(&slab_[band.Offset + i - band.BeginRow], v16);
+    } else {
+        Set4(i, j, _mm512_maskz_extractf32x4_ps(0xf, v16, 0));
+        Set4(i + 4, j, _mm512_maskz_extractf32x4_ps(0xf, v16, 1));
+        Set4(i + 8, j, _mm512_maskz_extractf32x4_ps(0xf, v16, 2));
+        Set4(i + 12, j, _mm512_maskz_extractf32x4_ps(0xf, v16, 3));
+    }
 }
+#endif  // CC_SIMD_DISPATCH
 }
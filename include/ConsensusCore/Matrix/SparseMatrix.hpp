@@ -8,12 +8,25 @@
 
 #include <ConsensusCore/Interval.hpp>
 #include <ConsensusCore/Matrix/AbstractMatrix.hpp>
-#include <ConsensusCore/Matrix/SparseVector.hpp>
+#include <ConsensusCore/SimdTarget.hpp>
 #include <ConsensusCore/Types.hpp>
 #include <ConsensusCore/Utils.hpp>
 
 namespace ConsensusCore {
 
+/// \brief A banded matrix storing, for each column, only a band of rows
+/// (plus padding) around the entries actually filled.
+///
+/// The bands of all columns live in one slab, with each column's offset
+/// and allocated rows kept in a side table, so that building, copying and
+/// destroying a matrix take a constant number of allocations, and columns
+/// filled one after another sit next to each other in memory.  A column
+/// whose band outgrows its slot moves to the end of the slab, growing it if
+/// need be, and one refilled with a much narrower band gives up the rest of
+/// its slot.  Growth compacts the live bands, dropping the space abandoned
+/// by moved and shrunk columns, as does abandoning more space than the
+/// columns hold, so that the slab stays within a small multiple of the
+/// bands.
 class SparseMatrix : public AbstractMatrix
 {
 public:  // Constructor, destructor
@@ -48,16 +61,56 @@ public:  // SSE accessors, which access 4 successive entries in a column
     __m128 Get4(int i, int j) const;
     void Set4(int i, int j, __m128 v);
 
+#ifdef CC_SIMD_DISPATCH
+public:  // AVX2 and AVX-512 accessors, for 8 and 16 successive entries
+    CC_TARGET_AVX2 __m256 Get8(int i, int j) const;
+    CC_TARGET_AVX2 void Set8(int i, int j, __m256 v);
+    CC_TARGET_AVX512 __m512 Get16(int i, int j) const;
+    CC_TARGET_AVX512 void Set16(int i, int j, __m512 v);
+#endif  // CC_SIMD_DISPATCH
+
 public:
     // Method SWIG clients can use to get a native matrix (e.g. Numpy)
     // mat must be filled as a ROW major matrix
     void ToHostMatrix(float** mat, int* rows, int* cols) const;
 
 private:
+    // Rows [BeginRow, EndRow) of a column are stored at slab_[Offset ...];
+    // the column owns Capacity entries from Offset on.
+    struct ColumnBand
+    {
+        int Offset;
+        int Capacity;
+        int BeginRow;
+        int EndRow;
+    };
+
+    // Rows allocated around a band, beyond what was asked for
+    static const int COLUMN_PADDING = 8;
+    // A slot is trimmed to a new band narrower than this percentage of it
+    static const int SHRINK_PERCENT = 80;
+
+    // Give column j the (emptied) band [beginRow, endRow), reusing its slot
+    // if it is large enough but not much too large
+    void AllocateColumn(int j, int beginRow, int endRow);
+    // Widen column j's band to [beginRow, endRow), keeping its contents
+    void ExpandColumn(int j, int beginRow, int endRow);
+    // Offset of a fresh run of entries at the end of the slab, compacting
+    // first if it is full or holds more abandoned entries than live slots
+    int Reserve(int entries);
+    // Pack the live bands into a new slab, with room for `entries` more
+    void Compact(int entries);
+    // Get4 and Set4 for rows straddling the band's edge; kept out of line
+    // so that the aligned paths inline into the fill kernels
+    __m128 Gather4(int i, int j) const;
+    void Scatter4(int i, int j, __m128 v4);
     void CheckInvariants(int column) const;
 
 private:
-    std::vector<SparseVector*> columns_;
+    std::vector<float> slab_;
+    int slabUsed_;
+    int abandoned_;  // entries before slabUsed_ that no column owns
+    std::vector<ColumnBand> bands_;
     int nCols_;
     int nRows_;
     int columnBeingEdited_;
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <ConsensusCore/Interval.hpp>
+
+namespace ConsensusCore {
+
+/// \brief Carry the band of a filled matrix over to a new template.
+///
+/// newColumnOf[j] is the column of the new template that old column j
+/// becomes (as given by TargetToQueryPositions); entries outside
+/// [0, newColumns) are dropped.  Each new column gets the union of the used
+/// row ranges of the old columns mapped onto it; columns nothing maps onto
+/// (inserted bases) take the union of their nearest seeded neighbours.
+/// The result is a band seed for RecursorBase::FillAlphaBeta.
+template <typename M>
+std::vector<Interval> RemapBandSeed(const M& matrix, const std::vector<int>& newColumnOf,
+                                    int newColumns)
+{
+    std::vector<Interval> seed(newColumns);
+    std::vector<bool> seeded(newColumns, false);
+    int oldColumns = std::min(matrix.Columns(), static_cast<int>(newColumnOf.size()));
+
+    for (int j = 0; j < oldColumns; j++) {
+        int c = newColumnOf[j];
+        if (c < 0 || c >= newColumns) continue;
+        Interval used = matrix.UsedRowRange(j);
+        seed[c] = seeded[c] ? RangeUnion(seed[c], used) : used;
+        seeded[c] = true;
+    }
+
+    int prev = -1;
+    for (int c = 0; c < newColumns; c++) {
+        if (seeded[c]) {
+            prev = c;
+            continue;
+        }
+        int next = c + 1;
+        while (next < newColumns && !seeded[next]) {
+            next++;
+        }
+        if (prev >= 0 && next < newColumns) {
+            seed[c] = RangeUnion(seed[prev], seed[next]);
+        } else if (prev >= 0) {
+            seed[c] = seed[prev];
+        } else if (next < newColumns) {
+            seed[c] = seed[next];
+        } else {
+            seed[c] = Interval(0, matrix.Rows());
+        }
+    }
+    return seed;
+}
+}
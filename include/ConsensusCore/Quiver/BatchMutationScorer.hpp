@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <ConsensusCore/Mutation.hpp>
+#include <ConsensusCore/Quiver/BatchRecursor.hpp>
+#include <ConsensusCore/Types.hpp>
+
+namespace ConsensusCore {
+
+/// \brief The MutationScorer analogue for a set of reads that share one
+/// template, filled BatchRecursor::LANES reads at a time.
+///
+/// Score() and ScoreMutation() return one entry per read, in the order the
+/// evaluators were given.  Mutations near the start of the template are
+/// scored by refilling alpha rather than extending beta.
+template <typename R>
+class BatchMutationScorer
+{
+public:
+    typedef typename R::MatrixType MatrixType;
+    typedef typename R::EvaluatorType EvaluatorType;
+    typedef R RecursorType;
+
+public:
+    BatchMutationScorer(const std::vector<QvEvaluator>& evaluators, const R& recursor);
+
+public:
+    int NumReads() const;
+
+    std::string Template() const;
+    void Template(std::string tpl);
+
+    std::vector<float> Scores() const;
+    std::vector<float> ScoreMutation(const Mutation& m) const;
+
+private:
+    void Fill();
+
+private:
+    R recursor_;
+    // Template swaps during ScoreMutation are undone before it returns
+    mutable std::vector<EvaluatorType> batches_;
+    std::vector<MatrixType> alphas_;
+    std::vector<MatrixType> betas_;
+    mutable std::vector<MatrixType> extendBuffers_;
+    std::vector<float> scores_;
+};
+
+typedef BatchMutationScorer<BatchQvRecursor> BatchQvMutationScorer;
+typedef BatchMutationScorer<BatchQvSumProductRecursor> BatchQvSumProductMutationScorer;
+}
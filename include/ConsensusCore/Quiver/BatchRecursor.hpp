@@ -0,0 +1,76 @@
+#pragma once
+
+#include <xmmintrin.h>
+
+#include <vector>
+
+#include <ConsensusCore/Matrix/InterleavedMatrix.hpp>
+#include <ConsensusCore/Quiver/InterleavedQvEvaluator.hpp>
+#include <ConsensusCore/Quiver/QuiverConfig.hpp>
+#include <ConsensusCore/Quiver/detail/Combiner.hpp>
+
+namespace ConsensusCore {
+
+/// \brief A recursor that fills up to four reads at once, one per SSE lane.
+///
+/// Where SseRecursor vectorizes down the (short, ragged) band of one read,
+/// this recursor vectorizes across reads: lane k of every InterleavedMatrix
+/// entry belongs to lane k of the InterleavedQvEvaluator.  Reads may differ
+/// in length, and lanes may hold different templates (windows): rows past
+/// the end of a read, and columns past the end of a lane's template, score
+/// -FLT_MAX in that lane and never feed back into cells it owns.  The band of
+/// a column is the union of the bands of the lanes live in it, and the first
+/// column and each lane's last column are filled completely so that every
+/// lane reaches its start and end cells.
+///
+/// LinkAlphaBeta and ExtendAlpha score one mutation in every lane, so they
+/// need all lanes to hold the same template.
+template <typename E, typename C>
+class BatchRecursor
+{
+public:  // Types
+    typedef InterleavedMatrix MatrixType;
+    typedef E EvaluatorType;
+    typedef C CombinerType;
+
+    static const int LANES = InterleavedMatrix::LANES;
+
+public:
+    /// \brief Raw fills, banded by the union of the guide's and the lanes'
+    ///        own bands; pass InterleavedMatrix::Null() for no guide.
+    void FillAlpha(const E& e, const InterleavedMatrix& guide, InterleavedMatrix& alpha) const;
+    void FillBeta(const E& e, const InterleavedMatrix& guide, InterleavedMatrix& beta) const;
+
+    /// \brief Fill both matrices, flip-flopping until every read's alpha and
+    ///        beta agree as RecursorBase::FillAlphaBeta does, and return the
+    ///        per-read scores, beta(0, 0).  The number of flip-flops the
+    ///        batch took is stored in numFlipFlops, if given.
+    /// \throws AlphaBetaMismatchException if some read never agrees
+    std::vector<float> FillAlphaBeta(const E& e, InterleavedMatrix& alpha, InterleavedMatrix& beta,
+                                     int* numFlipFlops = NULL) const;
+
+    /// \brief Per-read version of SimpleRecursor::LinkAlphaBeta.
+    std::vector<float> LinkAlphaBeta(const E& e, const InterleavedMatrix& alpha, int alphaColumn,
+                                     const InterleavedMatrix& beta, int betaColumn,
+                                     int absoluteColumn) const;
+
+    void ExtendAlpha(const E& e, const InterleavedMatrix& alpha, int beginColumn,
+                     InterleavedMatrix& ext, int numExtColumns = 2) const;
+
+public:
+    //
+    // Constructors
+    //
+    BatchRecursor(int movesAvailable, const BandingOptions& banding,
+                  const RecursorConfig& config = RecursorConfig());
+
+private:
+    int movesAvailable_;
+    BandingOptions bandingOptions_;
+    RecursorConfig recursorConfig_;
+};
+
+typedef BatchRecursor<InterleavedQvEvaluator, detail::ViterbiCombiner> BatchQvRecursor;
+
+typedef BatchRecursor<InterleavedQvEvaluator, detail::SumProductCombiner> BatchQvSumProductRecursor;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+#include <ConsensusCore/Interval.hpp>
+#include <ConsensusCore/Matrix/Int16Matrix.hpp>
+#include <ConsensusCore/Quiver/QuiverConfig.hpp>
+#include <ConsensusCore/Quiver/QvEvaluator.hpp>
+#include <ConsensusCore/Quiver/SseRecursor.hpp>
+#include <ConsensusCore/Quiver/detail/Combiner.hpp>
+
+namespace ConsensusCore {
+
+/// \brief A Viterbi recursor that fills alpha and beta in 16-bit fixed
+/// point, eight rows per SSE register.
+///
+/// Every column is kept relative to its own maximum (its base), so a column
+/// only needs to hold the spread of scores within its band, which banding
+/// bounds by ScoreDiff.  Quantized columns take half the memory of float
+/// ones.  Move scores are rounded to quanta of 1/Int16Matrix::ScaleFor
+/// (ScoreDiff): 1/128 for bands up to ScoreDiff 104, coarser for wider
+/// ones, so scores agree with SseRecursor's to within half a quantum per
+/// move on the best path.
+///
+/// The fixed-point fill gives up and refills the whole matrix with the float
+/// kernels whenever the int16 range does not suffice: when ScoreDiff is too
+/// wide for it even at the coarsest scale, when a column's maximum drops too far below its
+/// predecessor's, or when a move score is positive.  Link and extension are
+/// inherited and run in float.
+class Int16QvRecursor : public SseRecursor<Int16Matrix, QvEvaluator, detail::ViterbiCombiner>
+{
+public:
+    void FillAlpha(const QvEvaluator& e, const Int16Matrix& guide, Int16Matrix& alpha) const;
+    void FillAlpha(const QvEvaluator& e, const std::vector<Interval>& bandSeed,
+                   Int16Matrix& alpha) const;
+    void FillBeta(const QvEvaluator& e, const Int16Matrix& guide, Int16Matrix& beta) const;
+
+public:
+    //
+    // Constructors
+    //
+    Int16QvRecursor(int movesAvailable, const BandingOptions& banding,
+                    const RecursorConfig& config = RecursorConfig());
+
+private:
+    // Fixed-point fills; false if the matrix has to be refilled in float.
+    bool QuantizedFillAlpha(const QvEvaluator& e, const Int16Matrix& guide,
+                            const std::vector<Interval>& bandSeed, Int16Matrix& alpha) const;
+    bool QuantizedFillBeta(const QvEvaluator& e, const Int16Matrix& guide, Int16Matrix& beta) const;
+};
+}
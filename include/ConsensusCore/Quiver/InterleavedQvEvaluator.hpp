@@ -0,0 +1,208 @@
+#pragma once
+
+#include <xmmintrin.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <string>
+#include <vector>
+
+#include <ConsensusCore/Quiver/QvEvaluator.hpp>
+#include <ConsensusCore/Utils.hpp>
+
+namespace ConsensusCore {
+
+/// \brief The move scores of up to four QvEvaluators side by side, one read
+/// per SSE lane, so that the batched recursor reads a row of every lane with
+/// one load.
+///
+/// Each lane keeps its own template, so reads mapped to different windows
+/// (or strands) of a consensus can share a batch.  The view copies the
+/// evaluators' per-read score tables when it is built; templates are copied
+/// too and changed through LaneTemplate(k, tpl).  Moves a lane does not have
+/// (rows past the end of its read, lanes with no read) score -FLT_MAX.
+class InterleavedQvEvaluator
+{
+public:
+    static const int LANES = 4;
+
+public:
+    explicit InterleavedQvEvaluator(const std::vector<QvEvaluator>& es)
+        : numReads_(es.size())
+        , readLengths_(LANES, -1)
+        , templates_(LANES)
+        , stride_(0)
+        , tplColumns_(0)
+    {
+        if (es.empty() || es.size() > static_cast<size_t>(LANES)) {
+            throw InvalidInputError("A batch holds one to four reads");
+        }
+        int I = 0;
+        for (int k = 0; k < numReads_; k++) {
+            readLengths_[k] = es[k].ReadLength();
+            I = std::max(I, readLengths_[k]);
+        }
+        stride_ = LANES * (I + 1);
+        data_.assign(NUM_ROWS * stride_, -FLT_MAX);
+        std::fill(Row(BASE), Row(BASE) + stride_, NoBase());
+        std::fill(Row(DEL_TAG), Row(DEL_TAG) + stride_, NoBase());
+
+        std::fill(match_, match_ + LANES, -FLT_MAX);
+        for (int k = 0; k < numReads_; k++) {
+            const detail::QvScoreTable& scores = *es[k].scores_;
+            int Ik = readLengths_[k];
+            match_[k] = es[k].params_.Match;
+            for (int i = 0; i < Ik; i++) {
+                float base = scores.Base()[i];
+                Row(BASE)[LANES * i + k] = base;
+                Row(MISMATCH)[LANES * i + k] = scores.Mismatch()[i];
+                Row(BRANCH)[LANES * i + k] = scores.Branch()[i];
+                Row(NCE)[LANES * i + k] = scores.Nce()[i];
+                // A read base only merges into a homopolymer of itself
+                Row(MERGE)[LANES * i + k] = scores.Merge(static_cast<char>(base))[i];
+            }
+            for (int i = 0; i <= Ik; i++) {
+                Row(DEL_TAG)[LANES * i + k] = scores.DelTag()[i];
+                Row(DEL_WITH_TAG)[LANES * i + k] = scores.DelWithTag()[i];
+                Row(DEL_NO_TAG)[LANES * i + k] = scores.DelNoTag()[i];
+            }
+            templates_[k] = es[k].Template();
+        }
+        LayOutTemplates();
+    }
+
+    int NumReads() const { return numReads_; }
+
+    int ReadLength(int k) const { return readLengths_[k]; }
+
+    /// The longest read; the rows of a batch's matrices
+    int MaxReadLength() const { return stride_ / LANES - 1; }
+
+    /// Read length of each lane, -1 for lanes with no read
+    __m128 ReadLengths4() const
+    {
+        return _mm_setr_ps(readLengths_[0], readLengths_[1], readLengths_[2], readLengths_[3]);
+    }
+
+    std::string LaneTemplate(int k) const { return templates_[k]; }
+
+    void LaneTemplate(int k, const std::string& tpl)
+    {
+        assert(0 <= k && k < numReads_);
+        templates_[k] = tpl;
+        LayOutTemplates();
+    }
+
+    /// Give every lane the same template
+    void Template(const std::string& tpl)
+    {
+        std::fill(templates_.begin(), templates_.begin() + numReads_, tpl);
+        LayOutTemplates();
+    }
+
+    int TemplateLength(int k) const { return templates_[k].length(); }
+
+    /// The longest template; the columns of a batch's matrices, less one
+    int MaxTemplateLength() const { return tplColumns_ - 1; }
+
+    /// Template length of each lane, -1 for lanes with no read
+    __m128 TemplateLengths4() const
+    {
+        float lengths[LANES] = {-1.0f, -1.0f, -1.0f, -1.0f};
+        for (int k = 0; k < numReads_; k++) {
+            lengths[k] = TemplateLength(k);
+        }
+        return _mm_loadu_ps(lengths);
+    }
+
+    //
+    // Row i of every lane, against column j of each lane's template
+    //
+
+    __m128 Inc4(int i, int j) const
+    {
+        assert(0 <= i && i <= MaxReadLength());
+        assert(0 <= j && j < MaxTemplateLength());
+        __m128 mask = _mm_cmpeq_ps(Load4(BASE, i), TemplateBases4(j));
+        return MUX4(mask, _mm_loadu_ps(match_), Load4(MISMATCH, i));
+    }
+
+    __m128 Del4(int i, int j) const
+    {
+        assert(0 <= i && i <= MaxReadLength());
+        assert(0 <= j && j < MaxTemplateLength());
+        __m128 mask = _mm_cmpeq_ps(Load4(DEL_TAG, i), TemplateBases4(j));
+        return MUX4(mask, Load4(DEL_WITH_TAG, i), Load4(DEL_NO_TAG, i));
+    }
+
+    __m128 Extra4(int i, int j) const
+    {
+        assert(0 <= i && i <= MaxReadLength());
+        assert(0 <= j && j <= MaxTemplateLength());
+        __m128 mask = _mm_cmpeq_ps(Load4(BASE, i), TemplateBases4(j));
+        return MUX4(mask, Load4(BRANCH, i), Load4(NCE, i));
+    }
+
+    __m128 Merge4(int i, int j) const
+    {
+        assert(0 <= i && i <= MaxReadLength());
+        assert(0 <= j && j < MaxTemplateLength() - 1);
+        __m128 tpl4 = TemplateBases4(j);
+        __m128 mask = _mm_and_ps(_mm_cmpeq_ps(tpl4, TemplateBases4(j + 1)),
+                                 _mm_cmpeq_ps(Load4(BASE, i), tpl4));
+        return MUX4(mask, Load4(MERGE, i), _mm_set_ps1(-FLT_MAX));
+    }
+
+private:
+    enum
+    {
+        BASE,
+        MISMATCH,
+        BRANCH,
+        NCE,
+        DEL_TAG,
+        DEL_WITH_TAG,
+        DEL_NO_TAG,
+        MERGE,
+        NUM_ROWS
+    };
+
+    // Bases past the end of a read or template; they never compare equal
+    // to one another or to a real base.
+    static float NoBase() { return -1.0f; }
+    static float NoTemplateBase() { return -2.0f; }
+
+    void LayOutTemplates()
+    {
+        int J = 0;
+        for (int k = 0; k < numReads_; k++) {
+            J = std::max(J, TemplateLength(k));
+        }
+        // One sentinel column past the longest template, for Extra4(i, J)
+        tplColumns_ = J + 1;
+        tplBases_.assign(LANES * (tplColumns_ + 1), NoTemplateBase());
+        for (int k = 0; k < numReads_; k++) {
+            for (int j = 0; j < TemplateLength(k); j++) {
+                tplBases_[LANES * j + k] = templates_[k][j];
+            }
+        }
+    }
+
+    __m128 TemplateBases4(int j) const { return _mm_loadu_ps(&tplBases_[LANES * j]); }
+
+    __m128 Load4(int row, int i) const { return _mm_loadu_ps(Row(row) + LANES * i); }
+
+    float* Row(int k) { return &data_[k * stride_]; }
+    const float* Row(int k) const { return &data_[k * stride_]; }
+
+    int numReads_;
+    std::vector<int> readLengths_;
+    std::vector<std::string> templates_;
+    int stride_;
+    std::vector<float> data_;
+    int tplColumns_;
+    std::vector<float> tplBases_;
+    float match_[LANES];
+};
+}
@@ -3,6 +3,7 @@
 #pragma once
 
 #include <ConsensusCore/Matrix/AbstractMatrix.hpp>
+#include <ConsensusCore/Quiver/Int16Recursor.hpp>
 #include <ConsensusCore/Quiver/MutationScorer.hpp>
 #include <ConsensusCore/Quiver/QuiverConfig.hpp>
 #include <ConsensusCore/Quiver/SseRecursor.hpp>
@@ -41,6 +42,11 @@ public:
     virtual bool AddRead(const MappedRead& mappedRead, float threshold) = 0;
     virtual bool AddRead(const MappedRead& mappedRead) = 0;
 
+    // Add several reads at once, returning whether each was activated.
+    virtual std::vector<bool> AddReads(const std::vector<MappedRead>& mappedReads,
+                                       float threshold) = 0;
+    virtual std::vector<bool> AddReads(const std::vector<MappedRead>& mappedReads) = 0;
+
     virtual float Score(const Mutation& m) const = 0;
     virtual float FastScore(const Mutation& m) const = 0;
 
@@ -131,6 +137,14 @@ public:
     bool AddRead(const MappedRead& mappedRead, float threshold);
     bool AddRead(const MappedRead& mappedRead);
 
+    // Add several reads at once, returning whether each was activated.
+    // Where the recursor has a batched counterpart (the float SparseMatrix
+    // recursors), consecutive reads of one chemistry are filled together,
+    // one per SSE lane of a BatchRecursor, and each read's matrices copied
+    // out of the batch; the result is the same as adding them one by one.
+    std::vector<bool> AddReads(const std::vector<MappedRead>& mappedReads, float threshold);
+    std::vector<bool> AddReads(const std::vector<MappedRead>& mappedReads);
+
     float Score(const Mutation& m) const;
     float FastScore(const Mutation& m) const;
 
@@ -177,6 +191,9 @@ public:
 
 private:
     void CheckInvariants() const;
+    bool AddScorer(const MappedRead& mappedRead, ScorerType* scorer, float threshold);
+    void AddReadBatch(const std::vector<MappedRead>& batch, float threshold,
+                      std::vector<bool>* isActive);
 
 private:
     QuiverConfigTable quiverConfigByChemistry_;
@@ -189,4 +206,8 @@ private:
 typedef MultiReadMutationScorer<SparseSseQvRecursor> SparseSseQvMultiReadMutationScorer;
 typedef MultiReadMutationScorer<SparseSseQvSumProductRecursor>
     SparseSseQvSumProductMultiReadMutationScorer;
+typedef MultiReadMutationScorer<Int16QvRecursor> Int16QvMultiReadMutationScorer;
+typedef MultiReadMutationScorer<HalfSseQvRecursor> HalfSseQvMultiReadMutationScorer;
+typedef MultiReadMutationScorer<HalfSseQvSumProductRecursor>
+    HalfSseQvSumProductMultiReadMutationScorer;
 }
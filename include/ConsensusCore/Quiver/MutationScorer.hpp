@@ -4,11 +4,14 @@
 
 #include <boost/noncopyable.hpp>
 #include <string>
+#include <vector>
 
 // TODO(dalexander): how can we remove this include??
 //  We should move all template instantiations out to another
 //  header, I presume.
+#include <ConsensusCore/Interval.hpp>
 #include <ConsensusCore/Mutation.hpp>
+#include <ConsensusCore/Quiver/Int16Recursor.hpp>
 #include <ConsensusCore/Quiver/SimpleRecursor.hpp>
 #include <ConsensusCore/Quiver/SseRecursor.hpp>
 #include <ConsensusCore/Types.hpp>
@@ -24,6 +27,11 @@ public:
 
 public:
     MutationScorer(const EvaluatorType& evaluator, const R& recursor);
+    /// \brief Adopt alpha and beta already filled for this evaluator, e.g.
+    /// copied out of a BatchRecursor fill, instead of filling them.  The
+    /// scorer takes ownership of both.
+    MutationScorer(const EvaluatorType& evaluator, const R& recursor, MatrixType* alpha,
+                   MatrixType* beta, int numFlipFlops);
 
     MutationScorer(const MutationScorer& other);
     virtual ~MutationScorer();
@@ -32,6 +40,10 @@ public:
     std::string Template() const;
     void Template(std::string tpl);
 
+    /// \brief Install a new template, guiding the first alpha fill with
+    /// bandSeed (one row interval per column of the new template).
+    void Template(std::string tpl, const std::vector<Interval>& bandSeed);
+
     float Score() const;
     float ScoreMutation(const Mutation& m) const;
 
@@ -59,4 +71,7 @@ typedef MutationScorer<SparseSseQvRecursor> SparseSseQvMutationScorer;
 typedef MutationScorer<SparseSimpleQvSumProductRecursor> SparseSimpleQvSumProductMutationScorer;
 typedef MutationScorer<SparseSseQvSumProductRecursor> SparseSseQvSumProductMutationScorer;
 typedef MutationScorer<SparseSseEdnaRecursor> SparseSseEdnaMutationScorer;
+typedef MutationScorer<Int16QvRecursor> Int16QvMutationScorer;
+typedef MutationScorer<HalfSseQvRecursor> HalfSseQvMutationScorer;
+typedef MutationScorer<HalfSseQvSumProductRecursor> HalfSseQvSumProductMutationScorer;
 }
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <emmintrin.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <ConsensusCore/Matrix/Int16Matrix.hpp>
+#include <ConsensusCore/Quiver/QvEvaluator.hpp>
+
+namespace ConsensusCore {
+
+namespace detail {
+
+/// \brief A QvScoreTable's move scores rounded to 16-bit fixed point at one
+/// scale (quanta per unit of score).
+///
+/// Like the float table it depends only on the read, so an evaluator builds
+/// it once and keeps it across template changes.  Rows are indexed by read
+/// position and run from -LANES to ReadLength + LANES; rows outside the read
+/// score EMPTY_CELL, which saturating adds keep at the bottom of the int16
+/// range, and so do -FLT_MAX scores (merges out of non-homopolymers).
+class QuantizedQvScoreTable
+{
+public:
+    static const int LANES = 8;
+
+    enum
+    {
+        BASE,
+        MISMATCH,
+        BRANCH,
+        NCE,
+        DEL_TAG,
+        DEL_WITH_TAG,
+        DEL_NO_TAG,
+        MERGE_A,
+        NUM_ROWS = MERGE_A + 4
+    };
+
+public:
+    QuantizedQvScoreTable(const QvScoreTable& scores, float match, int readLength, int scale)
+        : readLength_(readLength)
+        , scale_(scale)
+        , stride_(readLength + 1 + 2 * LANES)
+        , data_(NUM_ROWS * stride_, Int16Matrix::EMPTY_CELL)
+        , quantizable_(true)
+    {
+        int I = readLength_;
+
+        std::fill(Row(BASE) - LANES, Row(BASE) - LANES + stride_, -1);
+        std::fill(Row(DEL_TAG) - LANES, Row(DEL_TAG) - LANES + stride_, -1);
+        match_ = Quantize(match);
+        for (int i = 0; i < I; i++) {
+            Row(BASE)[i] = static_cast<int16_t>(scores.Base()[i]);
+            Row(MISMATCH)[i] = Quantize(scores.Mismatch()[i]);
+            Row(BRANCH)[i] = Quantize(scores.Branch()[i]);
+            Row(NCE)[i] = Quantize(scores.Nce()[i]);
+            for (int b = 0; b < 4; b++) {
+                Row(MERGE_A + b)[i] = Quantize(scores.Merge("ACGT"[b])[i]);
+            }
+        }
+        for (int i = 0; i <= I; i++) {
+            Row(DEL_TAG)[i] = static_cast<int16_t>(scores.DelTag()[i]);
+            Row(DEL_WITH_TAG)[i] = Quantize(scores.DelWithTag()[i]);
+            Row(DEL_NO_TAG)[i] = Quantize(scores.DelNoTag()[i]);
+        }
+    }
+
+    int ReadLength() const { return readLength_; }
+
+    int Scale() const { return scale_; }
+
+    int16_t Match() const { return match_; }
+
+    /// False if some move score is positive, which the int16 recursor's
+    /// handling of empty cells does not allow for.
+    bool IsQuantizable() const { return quantizable_; }
+
+    // Row k; valid from -LANES to ReadLength + LANES
+    const int16_t* Row(int k) const { return &data_[k * stride_ + LANES]; }
+
+private:
+    int16_t Quantize(float score)
+    {
+        if (score <= -FLT_MAX) return Int16Matrix::EMPTY_CELL;
+        float q = std::floor(score * scale_ + 0.5f);
+        if (q > 0.0f) quantizable_ = false;
+        return static_cast<int16_t>(std::max(-32767.0f, std::min(32767.0f, q)));
+    }
+
+    int16_t* Row(int k) { return &data_[k * stride_ + LANES]; }
+
+    int readLength_;
+    int scale_;
+    int stride_;
+    std::vector<int16_t> data_;
+    int16_t match_;
+    bool quantizable_;
+};
+}
+
+/// \brief A 16-bit fixed-point view of a QvEvaluator's move scores, in
+/// units of 1/scale, eight rows to an SSE register.
+///
+/// The quantized score table is built the first time a view at a given
+/// scale is taken of an evaluator, and cached on the evaluator (and its
+/// copies) from then on; the view itself only refers to the table and to
+/// the evaluator's template, so it must not outlive the evaluator or a
+/// change of its template.  Rows outside the read (down to -LANES and up to
+/// ReadLength + LANES) score EMPTY_CELL.
+class QuantizedQvEvaluator
+{
+public:
+    static const int LANES = detail::QuantizedQvScoreTable::LANES;
+
+public:
+    QuantizedQvEvaluator(const QvEvaluator& e, int scale) : tpl_(e.tpl_)
+    {
+        if (!e.quantizedScores_ || e.quantizedScores_->Scale() != scale) {
+            e.quantizedScores_.reset(new detail::QuantizedQvScoreTable(*e.scores_, e.params_.Match,
+                                                                       e.ReadLength(), scale));
+        }
+        scores_ = e.quantizedScores_.get();
+    }
+
+    int ReadLength() const { return scores_->ReadLength(); }
+
+    int TemplateLength() const { return tpl_.length(); }
+
+    int Scale() const { return scores_->Scale(); }
+
+    bool IsQuantizable() const { return scores_->IsQuantizable(); }
+
+    int16_t Del(int i, int j) const
+    {
+        assert(0 <= j && j < TemplateLength() && 0 <= i && i <= ReadLength());
+        return (Row(DEL_TAG)[i] == tpl_[j]) ? Row(DEL_WITH_TAG)[i] : Row(DEL_NO_TAG)[i];
+    }
+
+    //
+    // SSE, rows i .. i + 7
+    //
+
+    __m128i Inc8(int i, int j) const
+    {
+        assert(-LANES <= i && i <= ReadLength());
+        assert(0 <= j && j < TemplateLength());
+        __m128i mask = _mm_cmpeq_epi16(Load8(BASE, i), _mm_set1_epi16(tpl_[j]));
+        return Mux8(mask, _mm_set1_epi16(scores_->Match()), Load8(MISMATCH, i));
+    }
+
+    __m128i Del8(int i, int j) const
+    {
+        assert(-LANES <= i && i <= ReadLength());
+        assert(0 <= j && j < TemplateLength());
+        __m128i mask = _mm_cmpeq_epi16(Load8(DEL_TAG, i), _mm_set1_epi16(tpl_[j]));
+        return Mux8(mask, Load8(DEL_WITH_TAG, i), Load8(DEL_NO_TAG, i));
+    }
+
+    __m128i Extra8(int i, int j) const
+    {
+        assert(-LANES <= i && i <= ReadLength());
+        assert(0 <= j && j <= TemplateLength());
+        // tpl_[TemplateLength()] is '\0', which matches no read base
+        __m128i mask = _mm_cmpeq_epi16(Load8(BASE, i), _mm_set1_epi16(tpl_.c_str()[j]));
+        return Mux8(mask, Load8(BRANCH, i), Load8(NCE, i));
+    }
+
+    __m128i Merge8(int i, int j) const
+    {
+        assert(-LANES <= i && i <= ReadLength());
+        assert(0 <= j && j < TemplateLength() - 1);
+        if (tpl_[j] != tpl_[j + 1]) return _mm_set1_epi16(Int16Matrix::EMPTY_CELL);
+        switch (tpl_[j]) {
+            case 'A':
+                return Load8(MERGE_A, i);
+            case 'C':
+                return Load8(MERGE_A + 1, i);
+            case 'G':
+                return Load8(MERGE_A + 2, i);
+            case 'T':
+                return Load8(MERGE_A + 3, i);
+            default:
+                return _mm_set1_epi16(Int16Matrix::EMPTY_CELL);
+        }
+    }
+
+private:
+    enum
+    {
+        BASE = detail::QuantizedQvScoreTable::BASE,
+        MISMATCH = detail::QuantizedQvScoreTable::MISMATCH,
+        BRANCH = detail::QuantizedQvScoreTable::BRANCH,
+        NCE = detail::QuantizedQvScoreTable::NCE,
+        DEL_TAG = detail::QuantizedQvScoreTable::DEL_TAG,
+        DEL_WITH_TAG = detail::QuantizedQvScoreTable::DEL_WITH_TAG,
+        DEL_NO_TAG = detail::QuantizedQvScoreTable::DEL_NO_TAG,
+        MERGE_A = detail::QuantizedQvScoreTable::MERGE_A
+    };
+
+    static __m128i Mux8(__m128i mask, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+
+    __m128i Load8(int k, int i) const
+    {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(Row(k) + i));
+    }
+
+    const int16_t* Row(int k) const { return scores_->Row(k); }
+
+    const std::string& tpl_;
+    const detail::QuantizedQvScoreTable* scores_;
+};
+}
@@ -32,6 +32,29 @@ struct BandingOptions
     BandingOptions(int, float scoreDiff, float, float) : ScoreDiff(scoreDiff) {}
 };
 
+/// \brief How hard a recursor tries to make its alpha and beta fills agree
+struct RecursorConfig
+{
+    /// Refills allowed after the first alpha and beta before giving up
+    int MaxFlipFlops;
+    /// Largest |alpha(I, J) - beta(0, 0)| accepted as agreement
+    float AlphaBetaMismatchTolerance;
+    /// Fraction of the full matrix above which the fills are rebanded
+    float RebandingThreshold;
+    /// Whether a template edit refills from the previous band (see
+    /// RemapBandSeed) rather than from scratch
+    bool SeedRefills;
+
+    RecursorConfig(int maxFlipFlops = 5, float alphaBetaMismatchTolerance = 0.2f,
+                   float rebandingThreshold = 0.04f, bool seedRefills = false)
+        : MaxFlipFlops(maxFlipFlops)
+        , AlphaBetaMismatchTolerance(alphaBetaMismatchTolerance)
+        , RebandingThreshold(rebandingThreshold)
+        , SeedRefills(seedRefills)
+    {
+    }
+};
+
 /// \brief A parameter vector for analysis using the QV model
 struct QvModelParams
 {
@@ -127,10 +150,12 @@ struct QuiverConfig
     BandingOptions Banding;
     float FastScoreThreshold;
     float AddThreshold;
+    RecursorConfig Recursor;
 
     QuiverConfig(const QvModelParams& qvParams, int movesAvailable,
                  const BandingOptions& bandingOptions, float fastScoreThreshold,
-                 float addThreshold = 1.0f);
+                 float addThreshold = 1.0f,
+                 const RecursorConfig& recursorConfig = RecursorConfig());
 
     QuiverConfig(const QuiverConfig& qvConfig);
 };
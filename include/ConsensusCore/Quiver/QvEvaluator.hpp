@@ -5,6 +5,8 @@
 #include <pmmintrin.h>
 #include <xmmintrin.h>
 
+#include <boost/shared_ptr.hpp>
+
 #include <algorithm>
 #include <cassert>
 #include <cfloat>
@@ -13,6 +15,7 @@
 #include <iostream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include <ConsensusCore/Features.hpp>
 #include <ConsensusCore/Quiver/QuiverConfig.hpp>
@@ -52,13 +55,119 @@ static inline int encodeTplBase(char base)
     }
 }
 
+namespace detail {
+
+class QuantizedQvScoreTable;
+
+/// \brief Per-read move scores for the QV model, laid out as one padded
+/// array per score so that a four-row block is a single unaligned load.
+///
+/// Everything here depends only on the read, the parameters and the pin
+/// flags, so it is computed once and shared (by pointer) among copies of an
+/// evaluator and across template changes.  Rows run from 0 to ReadLength,
+/// followed by padding; rows past the end of the read carry a base and tag
+/// of zero, which never compare equal to a template base.
+class QvScoreTable
+{
+public:
+    QvScoreTable(const QvSequenceFeatures& f, const QvModelParams& params, bool pinStart,
+                 bool pinEnd)
+        : stride_(f.Length() + TAIL_ROWS), data_(NUM_ROWS * stride_, 0.0f)
+    {
+        int I = f.Length();
+        for (int c = 0; c < 256; c++) {
+            mergeRow_[c] = NO_MERGE;
+        }
+        mergeRow_[static_cast<unsigned char>('A')] = MERGE_A;
+        mergeRow_[static_cast<unsigned char>('C')] = MERGE_A + 1;
+        mergeRow_[static_cast<unsigned char>('G')] = MERGE_A + 2;
+        mergeRow_[static_cast<unsigned char>('T')] = MERGE_A + 3;
+
+        for (int i = 0; i < stride_; i++) {
+            for (int b = 0; b < 4; b++) {
+                Row(MERGE_A + b)[i] = -FLT_MAX;
+            }
+            Row(NO_MERGE)[i] = -FLT_MAX;
+        }
+        for (int i = 0; i < I; i++) {
+            Row(BASE)[i] = f.SequenceAsFloat[i];
+            Row(MISMATCH)[i] = params.Mismatch + params.MismatchS * f.SubsQv[i];
+            Row(BRANCH)[i] = params.Branch + params.BranchS * f.InsQv[i];
+            Row(NCE)[i] = params.Nce + params.NceS * f.InsQv[i];
+            Row(DEL_TAG)[i] = f.DelTag[i];
+            Row(DEL_WITH_TAG)[i] = params.DeletionWithTag + params.DeletionWithTagS * f.DelQv[i];
+            Row(DEL_NO_TAG)[i] = params.DeletionN;
+            for (int b = 0; b < 4; b++) {
+                if (f[i] == "ACGT"[b]) {
+                    Row(MERGE_A + b)[i] = params.Merge[b] + params.MergeS[b] * f.MergeQv[i];
+                }
+            }
+        }
+        // The row past the end of the read has no tag
+        Row(DEL_WITH_TAG)[I] = Row(DEL_NO_TAG)[I] = params.DeletionN;
+        if (!pinStart) {
+            Row(DEL_WITH_TAG)[0] = Row(DEL_NO_TAG)[0] = 0.0f;
+        }
+        if (!pinEnd) {
+            Row(DEL_WITH_TAG)[I] = Row(DEL_NO_TAG)[I] = 0.0f;
+        }
+    }
+
+    const float* Base() const { return Row(BASE); }
+    const float* Mismatch() const { return Row(MISMATCH); }
+    const float* Branch() const { return Row(BRANCH); }
+    const float* Nce() const { return Row(NCE); }
+    const float* DelTag() const { return Row(DEL_TAG); }
+    const float* DelWithTag() const { return Row(DEL_WITH_TAG); }
+    const float* DelNoTag() const { return Row(DEL_NO_TAG); }
+
+    /// Merge scores into a homopolymer of tplBase; -FLT_MAX on rows whose
+    /// read base differs, and everywhere for non-ACGT template bases.
+    const float* Merge(char tplBase) const
+    {
+        return Row(mergeRow_[static_cast<unsigned char>(tplBase)]);
+    }
+
+private:
+    enum
+    {
+        BASE,
+        MISMATCH,
+        BRANCH,
+        NCE,
+        DEL_TAG,
+        DEL_WITH_TAG,
+        DEL_NO_TAG,
+        MERGE_A,
+        NO_MERGE = MERGE_A + 4,
+        NUM_ROWS
+    };
+
+    // Row ReadLength plus enough slack for the widest load starting there
+    static const int TAIL_ROWS = 16;
+
+    float* Row(int k) { return &data_[k * stride_]; }
+    const float* Row(int k) const { return &data_[k * stride_]; }
+
+    int stride_;
+    std::vector<float> data_;
+    unsigned char mergeRow_[256];
+};
+}
+
 //
 // Evaluator classes
 //
 
+class InterleavedQvEvaluator;
+class QuantizedQvEvaluator;
+
 /// \brief An Evaluator that can compute move scores using a QvSequenceFeatures
 class QvEvaluator
 {
+    friend class InterleavedQvEvaluator;
+    friend class QuantizedQvEvaluator;
+
 public:
     typedef QvSequenceFeatures FeaturesType;
     typedef QvModelParams ParamsType;
@@ -66,7 +175,12 @@ public:
 public:
     QvEvaluator(const Read& read, const std::string& tpl, const QvModelParams& params,
                 bool pinStart = true, bool pinEnd = true)
-        : read_(read), params_(params), tpl_(tpl), pinStart_(pinStart), pinEnd_(pinEnd)
+        : read_(read)
+        , params_(params)
+        , tpl_(tpl)
+        , pinStart_(pinStart)
+        , pinEnd_(pinEnd)
+        , scores_(new detail::QvScoreTable(read_.Features, params_, pinStart, pinEnd))
     {
     }
 
@@ -98,40 +212,27 @@ public:
     float Inc(int i, int j) const
     {
         assert(0 <= j && j < TemplateLength() && 0 <= i && i < ReadLength());
-        return (IsMatch(i, j)) ? params_.Match
-                               : params_.Mismatch + params_.MismatchS * Features().SubsQv[i];
+        return (IsMatch(i, j)) ? params_.Match : scores_->Mismatch()[i];
     }
 
     float Del(int i, int j) const
     {
         assert(0 <= j && j < TemplateLength() && 0 <= i && i <= ReadLength());
-        if ((!PinStart() && i == 0) || (!PinEnd() && i == ReadLength())) {
-            return 0.0f;
-        } else {
-            float tplBase = tpl_[j];
-            return (i < ReadLength() && tplBase == Features().DelTag[i])
-                       ? params_.DeletionWithTag + params_.DeletionWithTagS * Features().DelQv[i]
-                       : params_.DeletionN;
-        }
+        float tplBase = tpl_[j];
+        return (tplBase == scores_->DelTag()[i]) ? scores_->DelWithTag()[i]
+                                                 : scores_->DelNoTag()[i];
     }
 
     float Extra(int i, int j) const
     {
         assert(0 <= j && j <= TemplateLength() && 0 <= i && i < ReadLength());
-        return (j < TemplateLength() && IsMatch(i, j))
-                   ? params_.Branch + params_.BranchS * Features().InsQv[i]
-                   : params_.Nce + params_.NceS * Features().InsQv[i];
+        return (j < TemplateLength() && IsMatch(i, j)) ? scores_->Branch()[i] : scores_->Nce()[i];
     }
 
     float Merge(int i, int j) const
     {
         assert(0 <= j && j < TemplateLength() - 1 && 0 <= i && i < ReadLength());
-        if (!(Features()[i] == tpl_[j] && Features()[i] == tpl_[j + 1])) {
-            return -FLT_MAX;
-        } else {
-            int tplBase = encodeTplBase(tpl_[j]);
-            return params_.Merge[tplBase] + params_.MergeS[tplBase] * Features().MergeQv[i];
-        }
+        return (tpl_[j] == tpl_[j + 1]) ? scores_->Merge(tpl_[j])[i] : -FLT_MAX;
     }
 
     //
@@ -144,10 +245,9 @@ public:
         assert(0 <= j && j < TemplateLength());
         float tplBase = tpl_[j];
         __m128 match = _mm_set_ps1(params_.Match);
-        __m128 mismatch = AFFINE4(params_.Mismatch, params_.MismatchS, &Features().SubsQv[i]);
+        __m128 mismatch = _mm_loadu_ps(scores_->Mismatch() + i);
         // Mask to see it the base is equal to the template
-        __m128 mask =
-            _mm_cmpeq_ps(_mm_loadu_ps(&Features().SequenceAsFloat[i]), _mm_set_ps1(tplBase));
+        __m128 mask = _mm_cmpeq_ps(_mm_loadu_ps(scores_->Base() + i), _mm_set_ps1(tplBase));
         return MUX4(mask, match, mismatch);
     }
 
@@ -155,61 +255,125 @@ public:
     {
         assert(0 <= i && i <= ReadLength());
         assert(0 <= j && j < TemplateLength());
-        if (i != 0 && i + 3 != ReadLength()) {
-            float tplBase = tpl_[j];
-            __m128 delWTag =
-                AFFINE4(params_.DeletionWithTag, params_.DeletionWithTagS, &Features().DelQv[i]);
-            __m128 delNoTag = _mm_set_ps1(params_.DeletionN);
-            __m128 mask = _mm_cmpeq_ps(_mm_loadu_ps(&Features().DelTag[i]), _mm_set_ps1(tplBase));
-            return MUX4(mask, delWTag, delNoTag);
-        } else {
-            // Have to do PinStart/PinEnd logic, and weird
-            // logic for last row.  Punt.
-            __m128 res = _mm_setr_ps(Del(i + 0, j), Del(i + 1, j), Del(i + 2, j), Del(i + 3, j));
-            return res;
-        }
+        // Pinning and the tagless last row are already folded into the table
+        float tplBase = tpl_[j];
+        __m128 delWTag = _mm_loadu_ps(scores_->DelWithTag() + i);
+        __m128 delNoTag = _mm_loadu_ps(scores_->DelNoTag() + i);
+        __m128 mask = _mm_cmpeq_ps(_mm_loadu_ps(scores_->DelTag() + i), _mm_set_ps1(tplBase));
+        return MUX4(mask, delWTag, delNoTag);
     }
 
     __m128 Extra4(int i, int j) const
     {
         assert(0 <= i && i <= ReadLength() - 4);
         assert(0 <= j && j <= TemplateLength());
-        if (i != 0 && i + 3 != ReadLength()) {
-            float tplBase = tpl_[j];
-            __m128 branch = AFFINE4(params_.Branch, params_.BranchS, &Features().InsQv[i]);
-            __m128 nce = AFFINE4(params_.Nce, params_.NceS, &Features().InsQv[i]);
-
-            __m128 mask =
-                _mm_cmpeq_ps(_mm_loadu_ps(&Features().SequenceAsFloat[i]), _mm_set_ps1(tplBase));
-            return MUX4(mask, branch, nce);
-        } else {
-            __m128 res =
-                _mm_setr_ps(Extra(i + 0, j), Extra(i + 1, j), Extra(i + 2, j), Extra(i + 3, j));
-            return res;
-        }
+        // tpl_[TemplateLength()] is '\0', which matches no read base
+        float tplBase = tpl_[j];
+        __m128 branch = _mm_loadu_ps(scores_->Branch() + i);
+        __m128 nce = _mm_loadu_ps(scores_->Nce() + i);
+        __m128 mask = _mm_cmpeq_ps(_mm_loadu_ps(scores_->Base() + i), _mm_set_ps1(tplBase));
+        return MUX4(mask, branch, nce);
     }
 
     __m128 Merge4(int i, int j) const
     {
         assert(0 <= i && i <= ReadLength() - 4);
         assert(0 <= j && j < TemplateLength() - 1);
+        if (tpl_[j] == tpl_[j + 1]) {
+            return _mm_loadu_ps(scores_->Merge(tpl_[j]) + i);
+        } else {
+            return _mm_set_ps1(-FLT_MAX);
+        }
+    }
+
+#ifdef CC_SIMD_DISPATCH
+    //
+    // AVX2 and AVX-512, for the wide fill kernels; the same loads and
+    // selects as above, over 8 or 16 rows
+    //
+
+    CC_TARGET_AVX2 __m256 Inc8(int i, int j) const
+    {
+        assert(0 <= i && i <= ReadLength() - 8);
+        assert(0 <= j && j < TemplateLength());
+        __m256 mask = _mm256_cmp_ps(_mm256_loadu_ps(scores_->Base() + i), _mm256_set1_ps(tpl_[j]),
+                                    _CMP_EQ_OQ);
+        return _mm256_blendv_ps(_mm256_loadu_ps(scores_->Mismatch() + i),
+                                _mm256_set1_ps(params_.Match), mask);
+    }
+
+    CC_TARGET_AVX2 __m256 Del8(int i, int j) const
+    {
+        assert(0 <= i && i <= ReadLength());
+        assert(0 <= j && j < TemplateLength());
+        __m256 mask = _mm256_cmp_ps(_mm256_loadu_ps(scores_->DelTag() + i), _mm256_set1_ps(tpl_[j]),
+                                    _CMP_EQ_OQ);
+        return _mm256_blendv_ps(_mm256_loadu_ps(scores_->DelNoTag() + i),
+                                _mm256_loadu_ps(scores_->DelWithTag() + i), mask);
+    }
+
+    CC_TARGET_AVX2 __m256 Extra8(int i, int j) const
+    {
+        assert(0 <= i && i <= ReadLength() - 8);
+        assert(0 <= j && j <= TemplateLength());
+        __m256 mask = _mm256_cmp_ps(_mm256_loadu_ps(scores_->Base() + i), _mm256_set1_ps(tpl_[j]),
+                                    _CMP_EQ_OQ);
+        return _mm256_blendv_ps(_mm256_loadu_ps(scores_->Nce() + i),
+                                _mm256_loadu_ps(scores_->Branch() + i), mask);
+    }
+
+    CC_TARGET_AVX2 __m256 Merge8(int i, int j) const
+    {
+        assert(0 <= i && i <= ReadLength() - 8);
+        assert(0 <= j && j < TemplateLength() - 1);
+        if (tpl_[j] == tpl_[j + 1]) {
+            return _mm256_loadu_ps(scores_->Merge(tpl_[j]) + i);
+        } else {
+            return _mm256_set1_ps(-FLT_MAX);
+        }
+    }
 
-        float tplBase = tpl_[j];
-        float tplBaseNext = tpl_[j + 1];
-        int tplBase_ = encodeTplBase(tpl_[j]);
+    CC_TARGET_AVX512 __m512 Inc16(int i, int j) const
+    {
+        assert(0 <= i && i <= ReadLength() - 16);
+        assert(0 <= j && j < TemplateLength());
+        __mmask16 match = _mm512_cmp_ps_mask(_mm512_loadu_ps(scores_->Base() + i),
+                                             _mm512_set1_ps(tpl_[j]), _CMP_EQ_OQ);
+        return _mm512_mask_blend_ps(match, _mm512_loadu_ps(scores_->Mismatch() + i),
+                                    _mm512_set1_ps(params_.Match));
+    }
+
+    CC_TARGET_AVX512 __m512 Del16(int i, int j) const
+    {
+        assert(0 <= i && i <= ReadLength());
+        assert(0 <= j && j < TemplateLength());
+        __mmask16 tagged = _mm512_cmp_ps_mask(_mm512_loadu_ps(scores_->DelTag() + i),
+                                              _mm512_set1_ps(tpl_[j]), _CMP_EQ_OQ);
+        return _mm512_mask_blend_ps(tagged, _mm512_loadu_ps(scores_->DelNoTag() + i),
+                                    _mm512_loadu_ps(scores_->DelWithTag() + i));
+    }
 
-        __m128 merge =
-            AFFINE4(params_.Merge[tplBase_], params_.MergeS[tplBase_], &Features().MergeQv[i]);
-        __m128 noMerge = _mm_set_ps1(-FLT_MAX);
+    CC_TARGET_AVX512 __m512 Extra16(int i, int j) const
+    {
+        assert(0 <= i && i <= ReadLength() - 16);
+        assert(0 <= j && j <= TemplateLength());
+        __mmask16 match = _mm512_cmp_ps_mask(_mm512_loadu_ps(scores_->Base() + i),
+                                             _mm512_set1_ps(tpl_[j]), _CMP_EQ_OQ);
+        return _mm512_mask_blend_ps(match, _mm512_loadu_ps(scores_->Nce() + i),
+                                    _mm512_loadu_ps(scores_->Branch() + i));
+    }
 
-        if (tplBase == tplBaseNext) {
-            __m128 mask =
-                _mm_cmpeq_ps(_mm_loadu_ps(&Features().SequenceAsFloat[i]), _mm_set_ps1(tplBase));
-            return MUX4(mask, merge, noMerge);
+    CC_TARGET_AVX512 __m512 Merge16(int i, int j) const
+    {
+        assert(0 <= i && i <= ReadLength() - 16);
+        assert(0 <= j && j < TemplateLength() - 1);
+        if (tpl_[j] == tpl_[j + 1]) {
+            return _mm512_loadu_ps(scores_->Merge(tpl_[j]) + i);
         } else {
-            return noMerge;
+            return _mm512_set1_ps(-FLT_MAX);
         }
     }
+#endif  // CC_SIMD_DISPATCH
 
 protected:
     inline const QvSequenceFeatures& Features() const { return read_.Features; }
@@ -220,5 +384,9 @@ protected:
     std::string tpl_;
     bool pinStart_;
     bool pinEnd_;
+    boost::shared_ptr<const detail::QvScoreTable> scores_;
+    // The scores in fixed point, built by the first QuantizedQvEvaluator
+    // taken of this evaluator
+    mutable boost::shared_ptr<const detail::QuantizedQvScoreTable> quantizedScores_;
 };
 }
@@ -0,0 +1,17 @@
+#pragma once
+
+namespace ConsensusCore {
+
+/// \brief The vector instruction sets the recursors can dispatch to.
+/// The value of each level is the number of float lanes it processes.
+enum SimdLevel
+{
+    SIMD_SSE = 4,
+    SIMD_AVX2 = 8,
+    SIMD_AVX512 = 16
+};
+
+/// \brief The widest SimdLevel supported by both this build of the library
+///        and the CPU we are running on.  Detected once, via CPUID.
+SimdLevel DetectSimdLevel();
+}
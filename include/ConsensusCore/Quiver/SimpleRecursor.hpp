@@ -2,6 +2,9 @@
 
 #pragma once
 
+#include <vector>
+
+#include <ConsensusCore/Interval.hpp>
 #include <ConsensusCore/Matrix/DenseMatrix.hpp>
 #include <ConsensusCore/Quiver/QvEvaluator.hpp>
 #include <ConsensusCore/Quiver/detail/Combiner.hpp>
@@ -14,6 +17,7 @@ class SimpleRecursor : public detail::RecursorBase<M, E, C>
 {
 public:
     void FillAlpha(const E& e, const M& guide, M& alpha) const;
+    void FillAlpha(const E& e, const std::vector<Interval>& bandSeed, M& alpha) const;
     void FillBeta(const E& e, const M& guide, M& beta) const;
 
     float LinkAlphaBeta(const E& e, const M& alpha, int alphaColumn, const M& beta, int betaColumn,
@@ -29,7 +33,12 @@ public:
     //
     // Constructors
     //
-    SimpleRecursor(int movesAvailable, const BandingOptions& banding);
+    SimpleRecursor(int movesAvailable, const BandingOptions& banding,
+                   const RecursorConfig& config = RecursorConfig());
+
+private:
+    void FillAlpha(const E& e, const M& guide, const std::vector<Interval>& bandSeed,
+                   M& alpha) const;
 };
 
 typedef SimpleRecursor<DenseMatrix, QvEvaluator, detail::ViterbiCombiner> SimpleQvRecursor;
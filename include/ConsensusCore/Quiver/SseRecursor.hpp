@@ -2,11 +2,15 @@
 
 #pragma once
 
+#include <vector>
+
 #include <ConsensusCore/Edna/EdnaEvaluator.hpp>
+#include <ConsensusCore/Interval.hpp>
+#include <ConsensusCore/Matrix/CompactSparseMatrix.hpp>
 #include <ConsensusCore/Matrix/DenseMatrix.hpp>
 #include <ConsensusCore/Matrix/SparseMatrix.hpp>
 #include <ConsensusCore/Quiver/QvEvaluator.hpp>
-#include <ConsensusCore/Quiver/SimpleRecursor.hpp>
+#include <ConsensusCore/Quiver/SimdLevel.hpp>
 #include <ConsensusCore/Quiver/detail/Combiner.hpp>
 #include <ConsensusCore/Quiver/detail/RecursorBase.hpp>
 
@@ -17,6 +21,7 @@ class SseRecursor : public detail::RecursorBase<M, E, C>
 {
 public:
     void FillAlpha(const E& e, const M& guide, M& alpha) const;
+    void FillAlpha(const E& e, const std::vector<Interval>& bandSeed, M& alpha) const;
     void FillBeta(const E& e, const M& guide, M& beta) const;
 
     float LinkAlphaBeta(const E& e, const M& alpha, int alphaColumn, const M& beta, int betaColumn,
@@ -32,11 +37,23 @@ public:
     //
     // Constructors
     //
-    SseRecursor(int movesAvailable, const BandingOptions& banding);
+
+    /// \brief Build a recursor at the default vector width: the widest the
+    ///        CPU supports for sum-product fills, SSE for Viterbi fills,
+    ///        where the wider kernels have not been measurably faster.
+    SseRecursor(int movesAvailable, const BandingOptions& banding,
+                const RecursorConfig& config = RecursorConfig());
+
+    /// \brief Build a recursor whose fill kernels use at most the given
+    ///        vector width; the request is clamped to what the CPU supports.
+    SseRecursor(int movesAvailable, const BandingOptions& banding, SimdLevel simdLevel,
+                const RecursorConfig& config = RecursorConfig());
+
+    /// \brief The vector width the fill kernels dispatch to.
+    SimdLevel Simd() const;
 
 private:
-    // Used during bringup
-    SimpleRecursor<M, E, C> simpleRecursor_;
+    SimdLevel simdLevel_;
 };
 
 typedef SseRecursor<DenseMatrix, QvEvaluator, detail::ViterbiCombiner> SseQvRecursor;
@@ -49,4 +66,9 @@ typedef SseRecursor<SparseMatrix, QvEvaluator, detail::SumProductCombiner>
     SparseSseQvSumProductRecursor;
 
 typedef SseRecursor<SparseMatrix, EdnaEvaluator, detail::SumProductCombiner> SparseSseEdnaRecursor;
+
+typedef SseRecursor<HalfSparseMatrix, QvEvaluator, detail::ViterbiCombiner> HalfSseQvRecursor;
+
+typedef SseRecursor<HalfSparseMatrix, QvEvaluator, detail::SumProductCombiner>
+    HalfSseQvSumProductRecursor;
 }
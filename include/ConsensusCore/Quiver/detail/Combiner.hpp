@@ -21,6 +21,12 @@ public:
     static float Combine(float x, float y) { return std::max(x, y); }
 
     static __m128 Combine4(__m128 x4, __m128 y4) { return _mm_max_ps(x4, y4); }
+
+#ifdef CC_SIMD_DISPATCH
+    CC_TARGET_AVX2 static __m256 Combine8(__m256 x8, __m256 y8) { return _mm256_max_ps(x8, y8); }
+
+    CC_TARGET_AVX512 static __m512 Combine16(__m512 x16, __m512 y16) { return max16(x16, y16); }
+#endif  // CC_SIMD_DISPATCH
 };
 
 /// \brief A tag dispatch class calculating path-join score in the
@@ -31,6 +37,12 @@ public:
     static float Combine(float x, float y) { return logAdd(x, y); }
 
     static __m128 Combine4(__m128 x4, __m128 y4) { return logAdd4(x4, y4); }
+
+#ifdef CC_SIMD_DISPATCH
+    CC_TARGET_AVX2 static __m256 Combine8(__m256 x8, __m256 y8) { return logAdd8(x8, y8); }
+
+    CC_TARGET_AVX512 static __m512 Combine16(__m512 x16, __m512 y16) { return logAdd16(x16, y16); }
+#endif  // CC_SIMD_DISPATCH
 };
 }
 }
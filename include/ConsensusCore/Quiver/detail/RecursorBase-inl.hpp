@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <boost/tuple/tuple.hpp>
 #include <utility>
+#include <vector>
 
 #include <ConsensusCore/Interval.hpp>
 
@@ -68,5 +69,26 @@ inline bool RecursorBase<M, E, C>::RangeGuide(int j, const M& guide, const M& ma
 
     return true;
 }
+template <typename M, typename E, typename C>
+inline bool RecursorBase<M, E, C>::RangeGuide(int j, const M& guide, const M& matrix,
+                                              const std::vector<Interval>& bandSeed, int* beginRow,
+                                              int* endRow) const
+{
+    bool guided = RangeGuide(j, guide, matrix, beginRow, endRow);
+
+    if (bandSeed.empty()) {
+        return guided;
+    }
+
+    int rows = matrix.Rows();
+    int seedBeginRow = std::max(0, bandSeed[j].Begin);
+    int seedEndRow = std::max(seedBeginRow, std::min(rows, bandSeed[j].End));
+    Interval interval =
+        RangeUnion(Interval(seedBeginRow, seedEndRow), Interval(*beginRow, *endRow));
+
+    boost::tie(*beginRow, *endRow) = interval;
+
+    return true;
+}
 }
 }
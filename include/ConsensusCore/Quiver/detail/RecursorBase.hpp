@@ -5,7 +5,9 @@
 #include <algorithm>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include <ConsensusCore/Interval.hpp>
 #include <ConsensusCore/Quiver/QuiverConfig.hpp>
 #include <ConsensusCore/Types.hpp>
 
@@ -39,16 +41,31 @@ public:
     /// identical, refilling back-and-forth if necessary.
     virtual int FillAlphaBeta(const E& e, M& alpha, M& beta) const;
 
+    /// \brief Fill the alpha and beta matrices, starting from a band seed.
+    /// bandSeed holds, for each template column, a row interval that the
+    /// first alpha fill covers at least, e.g. a previous fill's band
+    /// carried over by RemapBandSeed.  An empty seed means no guide.
+    virtual int FillAlphaBeta(const E& e, M& alpha, M& beta,
+                              const std::vector<Interval>& bandSeed) const;
+
     /// \brief Reband alpha and beta matrices.
     /// This routine will reband alpha and beta to the convex hull
     /// of the maximum path through each and the inputs for column j.
     virtual bool RangeGuide(int j, const M& guide, const M& matrix, int* beginRow,
                             int* endRow) const;
 
+    /// \brief RangeGuide, widened to cover bandSeed[j] when a seed is given.
+    bool RangeGuide(int j, const M& guide, const M& matrix, const std::vector<Interval>& bandSeed,
+                    int* beginRow, int* endRow) const;
+
     /// \brief Raw FillAlpha, provided primarily for testing purposes.
     ///        Client code should use FillAlphaBeta.
     virtual void FillAlpha(const E& e, const M& guide, M& alpha) const = 0;
 
+    /// \brief Raw FillAlpha, guided by a band seed (one row interval per
+    ///        column) instead of a matrix.
+    virtual void FillAlpha(const E& e, const std::vector<Interval>& bandSeed, M& alpha) const = 0;
+
     /// \brief Raw FillBeta, provided primarily for testing purposes.
     ///        Client code should use FillAlphaBeta.
     virtual void FillBeta(const E& e, const M& guide, M& beta) const = 0;
@@ -61,12 +78,14 @@ public:
     /// \brief Read out the alignment from the computed alpha matrix.
     const PairwiseAlignment* Alignment(const E& e, const M& alpha) const;
 
-    RecursorBase(int movesAvailable, const BandingOptions& banding);
+    RecursorBase(int movesAvailable, const BandingOptions& banding,
+                 const RecursorConfig& config = RecursorConfig());
     virtual ~RecursorBase();
 
 protected:
     int movesAvailable_;
     BandingOptions bandingOptions_;
+    RecursorConfig recursorConfig_;
 };
 }
 }
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <xmmintrin.h>
+
+#include <ConsensusCore/Quiver/detail/SseMath.hpp>
+
+namespace ConsensusCore {
+
+class DenseMatrix;
+class SparseMatrix;
+class QvEvaluator;
+
+namespace detail {
+
+/// \brief Whether matrix type M and evaluator type E have the 8- and 16-wide
+/// accessors the AVX2/AVX-512 kernels need.  Recursors over other types fill
+/// at SSE width whatever the SIMD level.
+template <typename M, typename E>
+struct HasWideAccessors
+{
+    enum
+    {
+        value = false
+    };
+};
+
+template <>
+struct HasWideAccessors<DenseMatrix, QvEvaluator>
+{
+    enum
+    {
+        value = true
+    };
+};
+
+template <>
+struct HasWideAccessors<SparseMatrix, QvEvaluator>
+{
+    enum
+    {
+        value = true
+    };
+};
+
+//
+// Lane traits for the recursor fill kernels.  Each class maps the kernels'
+// vector operations onto the matrix and evaluator accessors of its width
+// (Get4, Inc8, Del16, ...), the combiners and the Extra scans, so a kernel
+// can be written once and instantiated for every vector width we dispatch
+// to.  Only matrix and evaluator types with native wide accessors get wide
+// kernels; see HasWideAccessors.
+//
+
+struct Simd4
+{
+    enum
+    {
+        Lanes = 4
+    };
+    typedef __m128 Vec;
+
+    static Vec Fill(float x) { return _mm_set_ps1(x); }
+    static Vec Load(const float* p) { return _mm_loadu_ps(p); }
+    static void Store(float* p, Vec v) { _mm_storeu_ps(p, v); }
+
+    template <typename C>
+    static Vec Combine(Vec x, Vec y)
+    {
+        return C::Combine4(x, y);
+    }
+
+    template <typename C>
+    static Vec PrefixScan(Vec x, Vec a, float carry)
+    {
+        return prefixScan4<C>(x, a, carry);
+    }
+
+    template <typename C>
+    static Vec SuffixScan(Vec x, Vec a, float carry)
+    {
+        return suffixScan4<C>(x, a, carry);
+    }
+
+    template <typename M>
+    static Vec Get(const M& m, int i, int j)
+    {
+        return m.Get4(i, j);
+    }
+
+    template <typename M>
+    static void Set(M& m, int i, int j, Vec v)
+    {
+        m.Set4(i, j, v);
+    }
+
+    template <typename E>
+    static Vec Inc(const E& e, int i, int j)
+    {
+        return e.Inc4(i, j);
+    }
+
+    template <typename E>
+    static Vec Del(const E& e, int i, int j)
+    {
+        return e.Del4(i, j);
+    }
+
+    template <typename E>
+    static Vec Extra(const E& e, int i, int j)
+    {
+        return e.Extra4(i, j);
+    }
+
+    template <typename E>
+    static Vec Merge(const E& e, int i, int j)
+    {
+        return e.Merge4(i, j);
+    }
+};
+
+#ifdef CC_SIMD_DISPATCH
+
+struct Simd8
+{
+    enum
+    {
+        Lanes = 8
+    };
+    typedef __m256 Vec;
+
+    CC_TARGET_AVX2 static Vec Fill(float x) { return _mm256_set1_ps(x); }
+    CC_TARGET_AVX2 static Vec Load(const float* p) { return _mm256_loadu_ps(p); }
+    CC_TARGET_AVX2 static void Store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+
+    template <typename C>
+    CC_TARGET_AVX2 static Vec Combine(Vec x, Vec y)
+    {
+        return C::Combine8(x, y);
+    }
+
+    template <typename C>
+    CC_TARGET_AVX2 static Vec PrefixScan(Vec x, Vec a, float carry)
+    {
+        return prefixScan8<C>(x, a, carry);
+    }
+
+    template <typename C>
+    CC_TARGET_AVX2 static Vec SuffixScan(Vec x, Vec a, float carry)
+    {
+        return suffixScan8<C>(x, a, carry);
+    }
+
+    template <typename M>
+    CC_TARGET_AVX2 static Vec Get(const M& m, int i, int j)
+    {
+        return m.Get8(i, j);
+    }
+
+    template <typename M>
+    CC_TARGET_AVX2 static void Set(M& m, int i, int j, Vec v)
+    {
+        m.Set8(i, j, v);
+    }
+
+    template <typename E>
+    CC_TARGET_AVX2 static Vec Inc(const E& e, int i, int j)
+    {
+        return e.Inc8(i, j);
+    }
+
+    template <typename E>
+    CC_TARGET_AVX2 static Vec Del(const E& e, int i, int j)
+    {
+        return e.Del8(i, j);
+    }
+
+    template <typename E>
+    CC_TARGET_AVX2 static Vec Extra(const E& e, int i, int j)
+    {
+        return e.Extra8(i, j);
+    }
+
+    template <typename E>
+    CC_TARGET_AVX2 static Vec Merge(const E& e, int i, int j)
+    {
+        return e.Merge8(i, j);
+    }
+};
+
+struct Simd16
+{
+    enum
+    {
+        Lanes = 16
+    };
+    typedef __m512 Vec;
+
+    CC_TARGET_AVX512 static Vec Fill(float x) { return _mm512_set1_ps(x); }
+    CC_TARGET_AVX512 static Vec Load(const float* p) { return _mm512_loadu_ps(p); }
+    CC_TARGET_AVX512 static void Store(float* p, Vec v) { _mm512_storeu_ps(p, v); }
+
+    template <typename C>
+    CC_TARGET_AVX512 static Vec Combine(Vec x, Vec y)
+    {
+        return C::Combine16(x, y);
+    }
+
+    template <typename C>
+    CC_TARGET_AVX512 static Vec PrefixScan(Vec x, Vec a, float carry)
+    {
+        return prefixScan16<C>(x, a, carry);
+    }
+
+    template <typename C>
+    CC_TARGET_AVX512 static Vec SuffixScan(Vec x, Vec a, float carry)
+    {
+        return suffixScan16<C>(x, a, carry);
+    }
+
+    template <typename M>
+    CC_TARGET_AVX512 static Vec Get(const M& m, int i, int j)
+    {
+        return m.Get16(i, j);
+    }
+
+    template <typename M>
+    CC_TARGET_AVX512 static void Set(M& m, int i, int j, Vec v)
+    {
+        m.Set16(i, j, v);
+    }
+
+    template <typename E>
+    CC_TARGET_AVX512 static Vec Inc(const E& e, int i, int j)
+    {
+        return e.Inc16(i, j);
+    }
+
+    template <typename E>
+    CC_TARGET_AVX512 static Vec Del(const E& e, int i, int j)
+    {
+        return e.Del16(i, j);
+    }
+
+    template <typename E>
+    CC_TARGET_AVX512 static Vec Extra(const E& e, int i, int j)
+    {
+        return e.Extra16(i, j);
+    }
+
+    template <typename E>
+    CC_TARGET_AVX512 static Vec Merge(const E& e, int i, int j)
+    {
+        return e.Merge16(i, j);
+    }
+};
+
+#endif  // CC_SIMD_DISPATCH
+}
+}
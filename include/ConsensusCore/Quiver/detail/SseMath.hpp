@@ -2,10 +2,14 @@
 
 #pragma once
 
+#include <emmintrin.h>
 #include <xmmintrin.h>
+#include <cfloat>
+#include <climits>
 #include <limits>
 
 #include <ConsensusCore/Quiver/detail/sse_mathfun.h>
+#include <ConsensusCore/SimdTarget.hpp>
 
 // todo: turn these into inline functions
 #define ADD4(a, b) _mm_add_ps((a), (b))
@@ -22,30 +26,358 @@ namespace detail {
 //
 // Log-space arithmetic
 //
-static const __m128 ones = _mm_set_ps1(1.0f);
+// logAdd(a, b) = max + log1p(exp(-|a - b|)).  Rather than the general
+// exp_ps/log_ps from sse_mathfun, the correction term is evaluated as
+//
+//   exp(d), d in [-30, 0]:  d = n ln2 + r with |r| <= ln2/2, and exp(r) from
+//                           the Cephes polynomial, scaled by 2^n through the
+//                           exponent bits;
+//   log1p(t), t in (0, 1]:  2 atanh(s) with s = t / (2 + t) <= 1/3, summed
+//                           as an odd series in s.
+//
+// The series length sets the accuracy: the absolute error of the correction
+// term is about 2 s^(2n+1) / (2n+1) for n terms, i.e. 1e-5 for 4, 1e-6 for 5
+// and 1e-7 (float resolution near 1) for the default 6.  Differences below
+// -30 contribute nothing at float precision, and clamping to -30 also maps
+// the NaN from (-inf) - (-inf) to a harmless value.
+//
+#ifndef CONSENSUSCORE_LOGADD_TERMS
+#define CONSENSUSCORE_LOGADD_TERMS 6
+#endif
+
+#define LOGADD_MIN_DIFF -30.0f
+#define LOGADD_LOG2E 1.44269504088896341f
+#define LOGADD_LN2_HI 0.693359375f
+#define LOGADD_LN2_LO -2.12194440e-4f
+#define LOGADD_EXP_P0 1.9875691500E-4f
+#define LOGADD_EXP_P1 1.3981999507E-3f
+#define LOGADD_EXP_P2 8.3334519073E-3f
+#define LOGADD_EXP_P3 4.1665795894E-2f
+#define LOGADD_EXP_P4 1.6666665459E-1f
+#define LOGADD_EXP_P5 5.0000001201E-1f
+
+/// \brief log1p(exp(d)) for d <= 0, using a series of the given length.
+template <int Terms>
+inline __m128 log1pExp4(__m128 d)
+{
+    d = _mm_max_ps(d, _mm_set_ps1(LOGADD_MIN_DIFF));
+
+    // exp(d)
+    __m128i n = _mm_cvtps_epi32(_mm_mul_ps(d, _mm_set_ps1(LOGADD_LOG2E)));
+    __m128 fn = _mm_cvtepi32_ps(n);
+    __m128 r = _mm_sub_ps(d, _mm_mul_ps(fn, _mm_set_ps1(LOGADD_LN2_HI)));
+    r = _mm_sub_ps(r, _mm_mul_ps(fn, _mm_set_ps1(LOGADD_LN2_LO)));
+    __m128 y = _mm_set_ps1(LOGADD_EXP_P0);
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set_ps1(LOGADD_EXP_P1));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set_ps1(LOGADD_EXP_P2));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set_ps1(LOGADD_EXP_P3));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set_ps1(LOGADD_EXP_P4));
+    y = _mm_add_ps(_mm_mul_ps(y, r), _mm_set_ps1(LOGADD_EXP_P5));
+    y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, _mm_mul_ps(r, r)), r), _mm_set_ps1(1.0f));
+    __m128i pow2n = _mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23);
+    __m128 t = _mm_mul_ps(y, _mm_castsi128_ps(pow2n));
+
+    // log1p(t)
+    __m128 s = _mm_div_ps(t, _mm_add_ps(t, _mm_set_ps1(2.0f)));
+    __m128 s2 = _mm_mul_ps(s, s);
+    __m128 q = _mm_set_ps1(1.0f / (2 * Terms - 1));
+    for (int k = Terms - 2; k >= 0; k--) {
+        q = _mm_add_ps(_mm_mul_ps(q, s2), _mm_set_ps1(1.0f / (2 * k + 1)));
+    }
+    return _mm_mul_ps(_mm_add_ps(s, s), q);
+}
 
 inline __m128 logAdd4(__m128 aa, __m128 bb)
 {
     __m128 max = _mm_max_ps(aa, bb);
     __m128 min = _mm_min_ps(aa, bb);
     __m128 diff = _mm_sub_ps(min, max);
-    return _mm_add_ps(max, log_ps(_mm_add_ps(ones, exp_ps(diff))));
-
-    // Precision of this is currently too low -- causes problems w/ Edna
-    // need a more accurate impl.
-    // return logAddApprox_ps(aa, bb);
+    return _mm_add_ps(max, log1pExp4<CONSENSUSCORE_LOGADD_TERMS>(diff));
 }
 
+// The scalar version runs the same engine in the low lane, so scalar and
+// vector code paths of a recursor agree exactly.
 inline float logAdd(float a, float b)
 {
-    __m128 aa = _mm_set_ps1(a);
-    __m128 bb = _mm_set_ps1(b);
-    __m128 acc = logAdd4(aa, bb);
+    return _mm_cvtss_f32(logAdd4(_mm_set_ss(a), _mm_set_ss(b)));
+}
+
+//
+// Scans for the Extra (insertion) recurrence
+//
+// Down a column, the Extra move makes each score a first-order recurrence
+//
+//      s[k] = C(x[k], s[k-1] + a[k])
+//
+// where x[k] is the score from all other moves and a[k] the Extra move
+// score.  Each step is the map y -> C(b, y + a), and two such maps compose
+// as (b2, a2) o (b1, a1) = (C(b2, b1 + a2), a1 + a2), because + distributes
+// over both max and logAdd.  The scans below compose the four maps of a
+// vector in two shift-and-combine steps (shifting in the identity map
+// (NEG_INF, 0)) and then apply the result to the carried-in score.
+//
+
+// Lane k takes lane k - d; lanes below d take the fill value.
+inline __m128 shiftLanesUp1(__m128 v, __m128 fill)
+{
+    return _mm_move_ss(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 1, 0, 3)), fill);
+}
+
+inline __m128 shiftLanesUp2(__m128 v, __m128 fill)
+{
+    return _mm_shuffle_ps(fill, v, _MM_SHUFFLE(1, 0, 1, 0));
+}
+
+// Lane k takes lane k + d; lanes above 3 - d take the fill value.
+inline __m128 shiftLanesDown1(__m128 v, __m128 fill)
+{
+    __m128 t = _mm_move_ss(v, fill);
+    return _mm_shuffle_ps(t, t, _MM_SHUFFLE(0, 3, 2, 1));
+}
+
+inline __m128 shiftLanesDown2(__m128 v, __m128 fill)
+{
+    return _mm_shuffle_ps(v, fill, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+/// \brief s[k] = C(x4[k], s[k-1] + a4[k]), with s[-1] = carry.
+template <typename C>
+inline __m128 prefixScan4(__m128 x4, __m128 a4, float carry)
+{
+    const __m128 negInf4 = _mm_set_ps1(-FLT_MAX);
+    const __m128 zero4 = _mm_setzero_ps();
+    __m128 b4 = x4;
+
+    b4 = C::Combine4(b4, _mm_add_ps(shiftLanesUp1(b4, negInf4), a4));
+    a4 = _mm_add_ps(a4, shiftLanesUp1(a4, zero4));
+    b4 = C::Combine4(b4, _mm_add_ps(shiftLanesUp2(b4, negInf4), a4));
+    a4 = _mm_add_ps(a4, shiftLanesUp2(a4, zero4));
+
+    return C::Combine4(b4, _mm_add_ps(_mm_set_ps1(carry), a4));
+}
+
+/// \brief s[k] = C(x4[k], s[k+1] + a4[k]), with s[4] = carry.
+template <typename C>
+inline __m128 suffixScan4(__m128 x4, __m128 a4, float carry)
+{
+    const __m128 negInf4 = _mm_set_ps1(-FLT_MAX);
+    const __m128 zero4 = _mm_setzero_ps();
+    __m128 b4 = x4;
+
+    b4 = C::Combine4(b4, _mm_add_ps(shiftLanesDown1(b4, negInf4), a4));
+    a4 = _mm_add_ps(a4, shiftLanesDown1(a4, zero4));
+    b4 = C::Combine4(b4, _mm_add_ps(shiftLanesDown2(b4, negInf4), a4));
+    a4 = _mm_add_ps(a4, shiftLanesDown2(a4, zero4));
+
+    return C::Combine4(b4, _mm_add_ps(_mm_set_ps1(carry), a4));
+}
+
+#ifdef CC_SIMD_DISPATCH
+//
+// Wide variants of the logAdd engine.
+//
+template <int Terms>
+CC_TARGET_AVX2 inline __m256 log1pExp8(__m256 d)
+{
+    d = _mm256_max_ps(d, _mm256_set1_ps(LOGADD_MIN_DIFF));
+
+    __m256i n = _mm256_cvtps_epi32(_mm256_mul_ps(d, _mm256_set1_ps(LOGADD_LOG2E)));
+    __m256 fn = _mm256_cvtepi32_ps(n);
+    __m256 r = _mm256_sub_ps(d, _mm256_mul_ps(fn, _mm256_set1_ps(LOGADD_LN2_HI)));
+    r = _mm256_sub_ps(r, _mm256_mul_ps(fn, _mm256_set1_ps(LOGADD_LN2_LO)));
+    __m256 y = _mm256_set1_ps(LOGADD_EXP_P0);
+    y = _mm256_add_ps(_mm256_mul_ps(y, r), _mm256_set1_ps(LOGADD_EXP_P1));
+    y = _mm256_add_ps(_mm256_mul_ps(y, r), _mm256_set1_ps(LOGADD_EXP_P2));
+    y = _mm256_add_ps(_mm256_mul_ps(y, r), _mm256_set1_ps(LOGADD_EXP_P3));
+    y = _mm256_add_ps(_mm256_mul_ps(y, r), _mm256_set1_ps(LOGADD_EXP_P4));
+    y = _mm256_add_ps(_mm256_mul_ps(y, r), _mm256_set1_ps(LOGADD_EXP_P5));
+    y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(y, _mm256_mul_ps(r, r)), r),
+                      _mm256_set1_ps(1.0f));
+    __m256i pow2n = _mm256_slli_epi32(_mm256_add_epi32(n, _mm256_set1_epi32(127)), 23);
+    __m256 t = _mm256_mul_ps(y, _mm256_castsi256_ps(pow2n));
+
+    __m256 s = _mm256_div_ps(t, _mm256_add_ps(t, _mm256_set1_ps(2.0f)));
+    __m256 s2 = _mm256_mul_ps(s, s);
+    __m256 q = _mm256_set1_ps(1.0f / (2 * Terms - 1));
+    for (int k = Terms - 2; k >= 0; k--) {
+        q = _mm256_add_ps(_mm256_mul_ps(q, s2), _mm256_set1_ps(1.0f / (2 * k + 1)));
+    }
+    return _mm256_mul_ps(_mm256_add_ps(s, s), q);
+}
+
+CC_TARGET_AVX2 inline __m256 logAdd8(__m256 aa, __m256 bb)
+{
+    __m256 max = _mm256_max_ps(aa, bb);
+    __m256 min = _mm256_min_ps(aa, bb);
+    __m256 diff = _mm256_sub_ps(min, max);
+    return _mm256_add_ps(max, log1pExp8<CONSENSUSCORE_LOGADD_TERMS>(diff));
+}
+
+// Several unmasked AVX-512 intrinsics pass gcc an undefined merge source,
+// which it reports as -Wmaybe-uninitialized once inlined; the zero-masked
+// forms with a full mask compile to the same instructions.
+CC_TARGET_AVX512 inline __m512 max16(__m512 a, __m512 b)
+{
+    return _mm512_maskz_max_ps(0xffff, a, b);
+}
+
+CC_TARGET_AVX512 inline __m512 min16(__m512 a, __m512 b)
+{
+    return _mm512_maskz_min_ps(0xffff, a, b);
+}
+
+template <int Terms>
+CC_TARGET_AVX512 inline __m512 log1pExp16(__m512 d)
+{
+    d = max16(d, _mm512_set1_ps(LOGADD_MIN_DIFF));
+
+    __m512i n = _mm512_maskz_cvtps_epi32(0xffff, _mm512_mul_ps(d, _mm512_set1_ps(LOGADD_LOG2E)));
+    __m512 fn = _mm512_maskz_cvtepi32_ps(0xffff, n);
+    __m512 r = _mm512_sub_ps(d, _mm512_mul_ps(fn, _mm512_set1_ps(LOGADD_LN2_HI)));
+    r = _mm512_sub_ps(r, _mm512_mul_ps(fn, _mm512_set1_ps(LOGADD_LN2_LO)));
+    __m512 y = _mm512_set1_ps(LOGADD_EXP_P0);
+    y = _mm512_add_ps(_mm512_mul_ps(y, r), _mm512_set1_ps(LOGADD_EXP_P1));
+    y = _mm512_add_ps(_mm512_mul_ps(y, r), _mm512_set1_ps(LOGADD_EXP_P2));
+    y = _mm512_add_ps(_mm512_mul_ps(y, r), _mm512_set1_ps(LOGADD_EXP_P3));
+    y = _mm512_add_ps(_mm512_mul_ps(y, r), _mm512_set1_ps(LOGADD_EXP_P4));
+    y = _mm512_add_ps(_mm512_mul_ps(y, r), _mm512_set1_ps(LOGADD_EXP_P5));
+    y = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(y, _mm512_mul_ps(r, r)), r),
+                      _mm512_set1_ps(1.0f));
+    __m512i pow2n =
+        _mm512_maskz_slli_epi32(0xffff, _mm512_add_epi32(n, _mm512_set1_epi32(127)), 23);
+    __m512 t = _mm512_mul_ps(y, _mm512_castsi512_ps(pow2n));
+
+    __m512 s = _mm512_div_ps(t, _mm512_add_ps(t, _mm512_set1_ps(2.0f)));
+    __m512 s2 = _mm512_mul_ps(s, s);
+    __m512 q = _mm512_set1_ps(1.0f / (2 * Terms - 1));
+    for (int k = Terms - 2; k >= 0; k--) {
+        q = _mm512_add_ps(_mm512_mul_ps(q, s2), _mm512_set1_ps(1.0f / (2 * k + 1)));
+    }
+    return _mm512_mul_ps(_mm512_add_ps(s, s), q);
+}
+
+CC_TARGET_AVX512 inline __m512 logAdd16(__m512 aa, __m512 bb)
+{
+    __m512 max = max16(aa, bb);
+    __m512 min = min16(aa, bb);
+    __m512 diff = _mm512_sub_ps(min, max);
+    return _mm512_add_ps(max, log1pExp16<CONSENSUSCORE_LOGADD_TERMS>(diff));
+}
+
+//
+// Wide variants of the Extra scans, composing the maps of all lanes in
+// log2(lanes) shift-and-combine steps across the whole register.
+//
+
+// Lane k takes lane k - D; lanes below D take the fill value.
+template <int D>
+CC_TARGET_AVX2 inline __m256 shiftLanesUp8(__m256 v, __m256 fill)
+{
+    const __m256i index = _mm256_setr_epi32(0, 1 - D, 2 - D, 3 - D, 4 - D, 5 - D, 6 - D, 7 - D);
+    return _mm256_blend_ps(_mm256_permutevar8x32_ps(v, index), fill, (1 << D) - 1);
+}
+
+// Lane k takes lane k + D; lanes above 7 - D take the fill value.
+template <int D>
+CC_TARGET_AVX2 inline __m256 shiftLanesDown8(__m256 v, __m256 fill)
+{
+    const __m256i index = _mm256_setr_epi32(D, 1 + D, 2 + D, 3 + D, 4 + D, 5 + D, 6 + D, 7);
+    return _mm256_blend_ps(_mm256_permutevar8x32_ps(v, index), fill, 0xff & (0xff << (8 - D)));
+}
+
+template <int D>
+CC_TARGET_AVX512 inline __m512 shiftLanesUp16(__m512 v, __m512 fill)
+{
+    const __m512i index =
+        _mm512_sub_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+                         _mm512_set1_epi32(D));
+    return _mm512_mask_permutexvar_ps(fill, static_cast<__mmask16>(0xffff << D), index, v);
+}
+
+template <int D>
+CC_TARGET_AVX512 inline __m512 shiftLanesDown16(__m512 v, __m512 fill)
+{
+    const __m512i index =
+        _mm512_add_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+                         _mm512_set1_epi32(D));
+    return _mm512_mask_permutexvar_ps(fill, static_cast<__mmask16>(0xffff >> D), index, v);
+}
+
+/// \brief s[k] = C(x8[k], s[k-1] + a8[k]), with s[-1] = carry.
+template <typename C>
+CC_TARGET_AVX2 inline __m256 prefixScan8(__m256 x8, __m256 a8, float carry)
+{
+    const __m256 negInf8 = _mm256_set1_ps(-FLT_MAX);
+    const __m256 zero8 = _mm256_setzero_ps();
+    __m256 b8 = x8;
+
+    b8 = C::Combine8(b8, _mm256_add_ps(shiftLanesUp8<1>(b8, negInf8), a8));
+    a8 = _mm256_add_ps(a8, shiftLanesUp8<1>(a8, zero8));
+    b8 = C::Combine8(b8, _mm256_add_ps(shiftLanesUp8<2>(b8, negInf8), a8));
+    a8 = _mm256_add_ps(a8, shiftLanesUp8<2>(a8, zero8));
+    b8 = C::Combine8(b8, _mm256_add_ps(shiftLanesUp8<4>(b8, negInf8), a8));
+    a8 = _mm256_add_ps(a8, shiftLanesUp8<4>(a8, zero8));
+
+    return C::Combine8(b8, _mm256_add_ps(_mm256_set1_ps(carry), a8));
+}
+
+/// \brief s[k] = C(x8[k], s[k+1] + a8[k]), with s[8] = carry.
+template <typename C>
+CC_TARGET_AVX2 inline __m256 suffixScan8(__m256 x8, __m256 a8, float carry)
+{
+    const __m256 negInf8 = _mm256_set1_ps(-FLT_MAX);
+    const __m256 zero8 = _mm256_setzero_ps();
+    __m256 b8 = x8;
+
+    b8 = C::Combine8(b8, _mm256_add_ps(shiftLanesDown8<1>(b8, negInf8), a8));
+    a8 = _mm256_add_ps(a8, shiftLanesDown8<1>(a8, zero8));
+    b8 = C::Combine8(b8, _mm256_add_ps(shiftLanesDown8<2>(b8, negInf8), a8));
+    a8 = _mm256_add_ps(a8, shiftLanesDown8<2>(a8, zero8));
+    b8 = C::Combine8(b8, _mm256_add_ps(shiftLanesDown8<4>(b8, negInf8), a8));
+    a8 = _mm256_add_ps(a8, shiftLanesDown8<4>(a8, zero8));
+
+    return C::Combine8(b8, _mm256_add_ps(_mm256_set1_ps(carry), a8));
+}
+
+/// \brief s[k] = C(x16[k], s[k-1] + a16[k]), with s[-1] = carry.
+template <typename C>
+CC_TARGET_AVX512 inline __m512 prefixScan16(__m512 x16, __m512 a16, float carry)
+{
+    const __m512 negInf16 = _mm512_set1_ps(-FLT_MAX);
+    const __m512 zero16 = _mm512_setzero_ps();
+    __m512 b16 = x16;
+
+    b16 = C::Combine16(b16, _mm512_add_ps(shiftLanesUp16<1>(b16, negInf16), a16));
+    a16 = _mm512_add_ps(a16, shiftLanesUp16<1>(a16, zero16));
+    b16 = C::Combine16(b16, _mm512_add_ps(shiftLanesUp16<2>(b16, negInf16), a16));
+    a16 = _mm512_add_ps(a16, shiftLanesUp16<2>(a16, zero16));
+    b16 = C::Combine16(b16, _mm512_add_ps(shiftLanesUp16<4>(b16, negInf16), a16));
+    a16 = _mm512_add_ps(a16, shiftLanesUp16<4>(a16, zero16));
+    b16 = C::Combine16(b16, _mm512_add_ps(shiftLanesUp16<8>(b16, negInf16), a16));
+    a16 = _mm512_add_ps(a16, shiftLanesUp16<8>(a16, zero16));
+
+    return C::Combine16(b16, _mm512_add_ps(_mm512_set1_ps(carry), a16));
+}
+
+/// \brief s[k] = C(x16[k], s[k+1] + a16[k]), with s[16] = carry.
+template <typename C>
+CC_TARGET_AVX512 inline __m512 suffixScan16(__m512 x16, __m512 a16, float carry)
+{
+    const __m512 negInf16 = _mm512_set1_ps(-FLT_MAX);
+    const __m512 zero16 = _mm512_setzero_ps();
+    __m512 b16 = x16;
+
+    b16 = C::Combine16(b16, _mm512_add_ps(shiftLanesDown16<1>(b16, negInf16), a16));
+    a16 = _mm512_add_ps(a16, shiftLanesDown16<1>(a16, zero16));
+    b16 = C::Combine16(b16, _mm512_add_ps(shiftLanesDown16<2>(b16, negInf16), a16));
+    a16 = _mm512_add_ps(a16, shiftLanesDown16<2>(a16, zero16));
+    b16 = C::Combine16(b16, _mm512_add_ps(shiftLanesDown16<4>(b16, negInf16), a16));
+    a16 = _mm512_add_ps(a16, shiftLanesDown16<4>(a16, zero16));
+    b16 = C::Combine16(b16, _mm512_add_ps(shiftLanesDown16<8>(b16, negInf16), a16));
+    a16 = _mm512_add_ps(a16, shiftLanesDown16<8>(a16, zero16));
 
-    // Use an aligned buf to extract
-    ALIGN16_BEG float buf[4] ALIGN16_END;
-    _mm_store_ps(&buf[0], acc);
-    return buf[0];
+    return C::Combine16(b16, _mm512_add_ps(_mm512_set1_ps(carry), a16));
 }
+#endif  // CC_SIMD_DISPATCH
 }
 }
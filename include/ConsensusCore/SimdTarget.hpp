@@ -0,0 +1,21 @@
+#pragma once
+
+//
+// Code wider than SSE is built into the library with per-function target
+// attributes and selected at runtime (see Quiver/SimdLevel.hpp), so that the
+// library as a whole can still be compiled for the baseline SSE3 target.
+// Matrices and evaluators declare their 8- and 16-wide accessors (Get8,
+// Inc16, ...) under CC_SIMD_DISPATCH with these attributes.
+//
+// The wide helpers are forced inline into the kernels: one that is not
+// returns a wide vector, so no vzeroupper precedes any SSE-encoded code it
+// calls, and every SSE instruction there then pays the AVX/SSE transition
+// penalty.  Inlined, they are compiled for the kernel's target along with it.
+//
+#if !defined(CONSENSUSCORE_NO_SIMD_DISPATCH) && !defined(SWIG) && defined(__GNUC__) && \
+    (defined(__x86_64__) || defined(__i386__))
+#define CC_SIMD_DISPATCH
+#define CC_TARGET_AVX2 __attribute__((target("avx2"), always_inline))
+#define CC_TARGET_AVX512 __attribute__((target("avx512f"), always_inline))
+#include <immintrin.h>
+#endif
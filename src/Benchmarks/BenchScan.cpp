@@ -0,0 +1,100 @@
+// Microbenchmark: the log-step Extra scans in SseMath.hpp against the scalar
+// cascade the recursors used before.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include <ConsensusCore/Quiver/detail/Combiner.hpp>
+#include <ConsensusCore/Quiver/detail/SseMath.hpp>
+
+using namespace ConsensusCore;          // NOLINT
+using namespace ConsensusCore::detail;  // NOLINT
+
+namespace {
+const int BLOCKS = 1 << 12;
+const int ROUNDS = 200;
+
+struct Inputs
+{
+    std::vector<float> x, a, carry;
+};
+
+Inputs RandomInputs()
+{
+    boost::random::mt19937 rng(42);
+    boost::random::uniform_real_distribution<float> score(-100.0f, 0.0f), move(-8.0f, -0.1f);
+    Inputs in;
+    for (int n = 0; n < 4 * BLOCKS; n++) {
+        in.x.push_back(score(rng));
+        in.a.push_back(move(rng));
+    }
+    for (int n = 0; n < BLOCKS; n++) {
+        in.carry.push_back(score(rng));
+    }
+    return in;
+}
+
+// The score5_ cascade, as formerly inlined in FillAlpha/ExtendAlpha
+template <typename C>
+__m128 CascadeScan4(__m128 x4, __m128 a4, float carry)
+{
+    float insScores4_[4], score5_[5];
+    _mm_storeu_ps(insScores4_, a4);
+    score5_[0] = carry;
+    _mm_storeu_ps(&score5_[1], x4);
+    for (int ii = 1; ii < 5; ii++) {
+        float v = C::Combine(score5_[ii], score5_[ii - 1] + insScores4_[ii - 1]);
+        score5_[ii] = v;
+    }
+    return _mm_loadu_ps(&score5_[1]);
+}
+
+template <typename C>
+__m128 LogStepScan4(__m128 x4, __m128 a4, float carry)
+{
+    return prefixScan4<C>(x4, a4, carry);
+}
+
+template <__m128 (*Scan)(__m128, __m128, float)>
+double Run(const Inputs& in, std::vector<float>* out)
+{
+    std::clock_t start = std::clock();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int n = 0; n < BLOCKS; n++) {
+            __m128 s4 = Scan(_mm_loadu_ps(&in.x[4 * n]), _mm_loadu_ps(&in.a[4 * n]), in.carry[n]);
+            _mm_storeu_ps(&(*out)[4 * n], s4);
+        }
+    }
+    double seconds = static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+    return 1e9 * seconds / (static_cast<double>(ROUNDS) * BLOCKS);
+}
+
+template <typename C>
+void Compare(const char* name, const Inputs& in)
+{
+    std::vector<float> cascade(4 * BLOCKS), scan(4 * BLOCKS);
+    double cascadeNs = Run<CascadeScan4<C> >(in, &cascade);
+    double scanNs = Run<LogStepScan4<C> >(in, &scan);
+
+    float maxDiff = 0;
+    for (int n = 0; n < 4 * BLOCKS; n++) {
+        maxDiff = std::max(maxDiff, std::fabs(cascade[n] - scan[n]));
+    }
+    std::printf("%-12s cascade %7.2f ns/block   log-step %7.2f ns/block   max |diff| %g\n", name,
+                cascadeNs, scanNs, maxDiff);
+}
+}
+
+int main()
+{
+    Inputs in = RandomInputs();
+    Compare<ViterbiCombiner>("Viterbi", in);
+    Compare<SumProductCombiner>("SumProduct", in);
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <ConsensusCore/Matrix/CompactSparseMatrix.hpp>
+
+#include <cassert>
+#include <cfloat>
+#include <limits>
+#include <vector>
+
+namespace ConsensusCore {
+
+// Performance insensitive routines are not inlined
+
+template <typename F>
+CompactSparseMatrix<F>::CompactSparseMatrix(int rows, int cols)
+    : rows_(rows)
+    , usedRanges_(cols, Interval(0, 0))
+    , blockBases_(cols)
+    , columns_(cols)
+    , scratch_(rows, -FLT_MAX)
+    , columnBeingEdited_(-1)
+    , dirtyRows_(rows, 0)
+{
+}
+
+template <typename F>
+CompactSparseMatrix<F>::CompactSparseMatrix(const CompactSparseMatrix& other)
+    : AbstractMatrix()
+    , rows_(other.rows_)
+    , usedRanges_(other.usedRanges_)
+    , blockBases_(other.blockBases_)
+    , columns_(other.columns_)
+    , scratch_(other.rows_, -FLT_MAX)
+    , columnBeingEdited_(-1)
+    , dirtyRows_(other.rows_, 0)
+{
+    assert(other.columnBeingEdited_ == -1);
+}
+
+template <typename F>
+CompactSparseMatrix<F>::~CompactSparseMatrix()
+{
+}
+
+template <typename F>
+int CompactSparseMatrix<F>::UsedEntries() const
+{
+    int filledEntries = 0;
+    for (int col = 0; col < Columns(); ++col) {
+        filledEntries += usedRanges_[col].End - usedRanges_[col].Begin;
+    }
+    return filledEntries;
+}
+
+template <typename F>
+int CompactSparseMatrix<F>::AllocatedEntries() const
+{
+    int allocatedEntries = scratch_.size();
+    for (int col = 0; col < Columns(); ++col) {
+        allocatedEntries += columns_[col].capacity() + blockBases_[col].capacity();
+    }
+    return allocatedEntries;
+}
+
+template <typename F>
+void CompactSparseMatrix<F>::ToHostMatrix(float** mat, int* rows, int* cols) const
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    *mat = new float[Rows() * Columns()];
+    *rows = Rows();
+    *cols = Columns();
+    for (int i = 0; i < Rows(); i++) {
+        for (int j = 0; j < Columns(); j++) {
+            (*mat)[i * Columns() + j] = IsAllocated(i, j) ? Get(i, j) : nan;
+        }
+    }
+}
+
+template class CompactSparseMatrix<HalfFormat>;
+}
@@ -0,0 +1,92 @@
+#include <ConsensusCore/Matrix/Int16Matrix.hpp>
+
+#include <cassert>
+#include <cfloat>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace ConsensusCore {
+
+const int Int16Matrix::SCALE;
+const int Int16Matrix::MIN_SCALE;
+const int16_t Int16Matrix::EMPTY_CELL;
+const int16_t Int16Matrix::FLOOR;
+
+// Performance insensitive routines are not inlined
+
+Int16Matrix::Int16Matrix(int rows, int cols)
+    : rows_(rows)
+    , usedRanges_(cols, Interval(0, 0))
+    , bases_(cols, 0)
+    , quanta_(cols, 1.0f)
+    , isQuantized_(cols, false)
+    , quantized_(cols)
+    , floats_(cols)
+    , scratch_(rows, -FLT_MAX)
+    , columnBeingEdited_(-1)
+    , dirtyRows_(rows, 0)
+{
+}
+
+Int16Matrix::Int16Matrix(const Int16Matrix& other)
+    : AbstractMatrix()
+    , rows_(other.rows_)
+    , usedRanges_(other.usedRanges_)
+    , bases_(other.bases_)
+    , quanta_(other.quanta_)
+    , isQuantized_(other.isQuantized_)
+    , quantized_(other.quantized_)
+    , floats_(other.floats_)
+    , scratch_(other.rows_, -FLT_MAX)
+    , columnBeingEdited_(-1)
+    , dirtyRows_(other.rows_, 0)
+{
+    assert(other.columnBeingEdited_ == -1);
+}
+
+Int16Matrix::~Int16Matrix() {}
+
+int Int16Matrix::ScaleFor(float scoreDiff)
+{
+    // Room, in units of score, for a column's maximum to fall below its
+    // predecessor's, i.e. for the worst deletion score
+    const float headroom = 24.0f;
+
+    for (int scale = SCALE; scale >= MIN_SCALE; scale /= 2) {
+        if ((scoreDiff + headroom) * scale <= -FLOOR) return scale;
+    }
+    return 0;
+}
+
+int Int16Matrix::UsedEntries() const
+{
+    int filledEntries = 0;
+    for (int col = 0; col < Columns(); ++col) {
+        filledEntries += usedRanges_[col].End - usedRanges_[col].Begin;
+    }
+    return filledEntries;
+}
+
+int Int16Matrix::AllocatedEntries() const
+{
+    int allocatedEntries = scratch_.size();
+    for (int col = 0; col < Columns(); ++col) {
+        allocatedEntries += quantized_[col].capacity() + floats_[col].capacity();
+    }
+    return allocatedEntries;
+}
+
+void Int16Matrix::ToHostMatrix(float** mat, int* rows, int* cols) const
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    *mat = new float[Rows() * Columns()];
+    *rows = Rows();
+    *cols = Columns();
+    for (int i = 0; i < Rows(); i++) {
+        for (int j = 0; j < Columns(); j++) {
+            (*mat)[i * Columns() + j] = IsAllocated(i, j) ? Get(i, j) : nan;
+        }
+    }
+}
+}
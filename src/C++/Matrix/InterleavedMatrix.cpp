@@ -0,0 +1,38 @@
+#include <ConsensusCore/Matrix/InterleavedMatrix.hpp>
+
+#include <cfloat>
+#include <vector>
+
+namespace ConsensusCore {
+
+// Performance insensitive routines are not inlined
+
+InterleavedMatrix::InterleavedMatrix(int rows, int cols)
+    : rows_(rows)
+    , usedRanges_(cols, Interval(0, 0))
+    , columns_(cols)
+    , scratch_(LANES * rows, -FLT_MAX)
+    , columnBeingEdited_(-1)
+{
+}
+
+InterleavedMatrix::~InterleavedMatrix() {}
+
+int InterleavedMatrix::UsedEntries() const
+{
+    int filledEntries = 0;
+    for (int col = 0; col < Columns(); ++col) {
+        filledEntries += LANES * (usedRanges_[col].End - usedRanges_[col].Begin);
+    }
+    return filledEntries;
+}
+
+int InterleavedMatrix::AllocatedEntries() const
+{
+    int allocatedEntries = scratch_.size();
+    for (int col = 0; col < Columns(); ++col) {
+        allocatedEntries += columns_[col].capacity();
+    }
+    return allocatedEntries;
+}
+}
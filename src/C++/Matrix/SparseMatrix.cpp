@@ -5,44 +5,163 @@
 #include <limits>
 #include <vector>
 
+#include <ConsensusCore/LFloat.hpp>
 #include <ConsensusCore/Matrix/SparseMatrix.hpp>
 
 namespace ConsensusCore {
 // Performance insensitive routines are not inlined
 
+const int SparseMatrix::COLUMN_PADDING;
+const int SparseMatrix::SHRINK_PERCENT;
+
 SparseMatrix::SparseMatrix(int rows, int cols)
-    : columns_(cols)
+    : slab_()
+    , slabUsed_(0)
+    , abandoned_(0)
+    , bands_(cols)
     , nCols_(cols)
     , nRows_(rows)
     , columnBeingEdited_(-1)
     , usedRanges_(cols, Interval(0, 0))
 {
-    for (int j = 0; j < nCols_; j++) {
-        columns_[j] = NULL;
-    }
+    ColumnBand empty = {0, 0, 0, 0};
+    std::fill(bands_.begin(), bands_.end(), empty);
 }
 
 SparseMatrix::SparseMatrix(const SparseMatrix& other)
-    : columns_(other.nCols_)
+    : AbstractMatrix()
+    , slab_()
+    , slabUsed_(0)
+    , abandoned_(0)
+    , bands_(other.bands_)
     , nCols_(other.nCols_)
     , nRows_(other.nRows_)
     , columnBeingEdited_(other.columnBeingEdited_)
     , usedRanges_(other.usedRanges_)
 {
+    // Copy the live bands only, packed in column order
+    int entries = 0;
+    for (int j = 0; j < nCols_; j++) {
+        entries += bands_[j].EndRow - bands_[j].BeginRow;
+    }
+    slab_.resize(entries);
     for (int j = 0; j < nCols_; j++) {
-        if (other.columns_[j] != NULL) {
-            columns_[j] = new SparseVector(*other.columns_[j]);
+        ColumnBand& band = bands_[j];
+        int n = band.EndRow - band.BeginRow;
+        std::copy(other.slab_.begin() + band.Offset, other.slab_.begin() + band.Offset + n,
+                  slab_.begin() + slabUsed_);
+        band.Offset = slabUsed_;
+        band.Capacity = n;
+        slabUsed_ += n;
+    }
+}
+
+SparseMatrix::~SparseMatrix() {}
+
+void SparseMatrix::AllocateColumn(int j, int beginRow, int endRow)
+{
+    int n = endRow - beginRow;
+    ColumnBand& band = bands_[j];
+    band.BeginRow = band.EndRow = 0;
+    if (n > band.Capacity || 100 * n < SHRINK_PERCENT * band.Capacity) {
+        // The old slot is reclaimed at the next compaction
+        abandoned_ += band.Capacity;
+        band.Capacity = 0;
+        band.Offset = Reserve(n);
+        band.Capacity = n;
+    }
+    band.BeginRow = beginRow;
+    band.EndRow = endRow;
+    std::fill(slab_.begin() + band.Offset, slab_.begin() + band.Offset + n, Zero<lfloat>());
+    DEBUG_ONLY(CheckInvariants(j));
+}
+
+void SparseMatrix::ExpandColumn(int j, int beginRow, int endRow)
+{
+    assert(0 <= beginRow && beginRow <= endRow && endRow <= nRows_);
+    int n = endRow - beginRow;
+    int oldLength = bands_[j].EndRow - bands_[j].BeginRow;
+    if (n > bands_[j].Capacity) {
+        if (bands_[j].Offset + bands_[j].Capacity == slabUsed_ &&
+            bands_[j].Offset + n <= static_cast<int>(slab_.size())) {
+            // The last band in the slab grows in place
+            slabUsed_ = bands_[j].Offset + n;
+            bands_[j].Capacity = n;
         } else {
-            columns_[j] = NULL;
+            // Move to a slot with room to grow, so that a column widened a
+            // few rows at a time is not copied on every step.  The old slot
+            // is reclaimed at the next compaction; Reserve may itself
+            // compact, moving this column.
+            int capacity = min(max(n, 2 * bands_[j].Capacity), nRows_);
+            int offset = Reserve(capacity);
+            ColumnBand& band = bands_[j];
+            std::copy(slab_.begin() + band.Offset, slab_.begin() + band.Offset + oldLength,
+                      slab_.begin() + offset);
+            abandoned_ += band.Capacity;
+            band.Offset = offset;
+            band.Capacity = capacity;
         }
     }
+
+    // Slide the old contents to their new rows, and empty the rest
+    ColumnBand& band = bands_[j];
+    float* column = &slab_[band.Offset];
+    int shift = (oldLength > 0) ? band.BeginRow - beginRow : 0;
+    std::copy_backward(column, column + oldLength, column + shift + oldLength);
+    std::fill(column, column + shift, Zero<lfloat>());
+    std::fill(column + shift + oldLength, column + n, Zero<lfloat>());
+    band.BeginRow = beginRow;
+    band.EndRow = endRow;
+    DEBUG_ONLY(CheckInvariants(j));
 }
 
-SparseMatrix::~SparseMatrix()
+int SparseMatrix::Reserve(int entries)
 {
+    if (slabUsed_ + entries > static_cast<int>(slab_.size()) ||
+        abandoned_ > slabUsed_ - abandoned_) {
+        Compact(entries);
+    }
+    int offset = slabUsed_;
+    slabUsed_ += entries;
+    return offset;
+}
+
+void SparseMatrix::Compact(int entries)
+{
+    // Trim each slot to its band, and leave as much room again as is live
+    int live = 0;
     for (int j = 0; j < nCols_; j++) {
-        if (columns_[j] != NULL) delete columns_[j];
+        live += bands_[j].EndRow - bands_[j].BeginRow;
     }
+    std::vector<float> slab(2 * (live + entries), Zero<lfloat>());
+    int used = 0;
+    for (int j = 0; j < nCols_; j++) {
+        ColumnBand& band = bands_[j];
+        int n = band.EndRow - band.BeginRow;
+        std::copy(slab_.begin() + band.Offset, slab_.begin() + band.Offset + n,
+                  slab.begin() + used);
+        band.Offset = used;
+        band.Capacity = n;
+        used += n;
+    }
+    slab_.swap(slab);
+    slabUsed_ = used;
+    abandoned_ = 0;
+}
+
+__m128 SparseMatrix::Gather4(int i, int j) const
+{
+    return _mm_set_ps(Get(i + 3, j), Get(i + 2, j), Get(i + 1, j), Get(i + 0, j));
+}
+
+void SparseMatrix::Scatter4(int i, int j, __m128 v4)
+{
+    float vbuf[4];
+    _mm_storeu_ps(vbuf, v4);
+    Set(i + 0, j, vbuf[0]);
+    Set(i + 1, j, vbuf[1]);
+    Set(i + 2, j, vbuf[2]);
+    Set(i + 3, j, vbuf[3]);
 }
 
 int SparseMatrix::UsedEntries() const
@@ -59,9 +178,10 @@ int SparseMatrix::UsedEntries() const
 
 int SparseMatrix::AllocatedEntries() const
 {
+    // Entries held by the columns, not counting slack in the slab
     int sum = 0;
     for (int j = 0; j < nCols_; j++) {
-        sum += (columns_[j] != NULL ? columns_[j]->AllocatedEntries() : 0);
+        sum += bands_[j].Capacity;
     }
     return sum;
 }
@@ -79,10 +199,19 @@ void SparseMatrix::ToHostMatrix(float** mat, int* rows, int* cols) const
     }
 }
 
-void SparseMatrix::CheckInvariants(int) const
+void SparseMatrix::CheckInvariants(int
+#ifndef NDEBUG
+                                       column
+#endif
+                                   ) const
 {
-    for (int j = 0; j < nCols_; j++) {
-        if (columns_[j] != NULL) columns_[j]->CheckInvariants();
-    }
+#ifndef NDEBUG
+    assert(0 <= slabUsed_ && slabUsed_ <= static_cast<int>(slab_.size()));
+    assert(0 <= abandoned_ && abandoned_ <= slabUsed_);
+    const ColumnBand& band = bands_[column];
+    assert(0 <= band.BeginRow && band.BeginRow <= band.EndRow && band.EndRow <= nRows_);
+    assert(band.EndRow - band.BeginRow <= band.Capacity);
+    assert(band.Capacity == 0 || (0 <= band.Offset && band.Offset + band.Capacity <= slabUsed_));
+#endif
 }
 }
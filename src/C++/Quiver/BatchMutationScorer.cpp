@@ -0,0 +1,158 @@
+#include <ConsensusCore/Quiver/BatchMutationScorer.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <string>
+#include <vector>
+
+#include <ConsensusCore/Matrix/InterleavedMatrix.hpp>
+#include <ConsensusCore/Mutation.hpp>
+#include <ConsensusCore/Quiver/BatchRecursor.hpp>
+
+#define EXTEND_BUFFER_COLUMNS 8
+
+namespace ConsensusCore {
+
+template <typename R>
+BatchMutationScorer<R>::BatchMutationScorer(const std::vector<QvEvaluator>& evaluators,
+                                            const R& recursor)
+    : recursor_(recursor)
+{
+    if (evaluators.empty()) {
+        throw InvalidInputError("BatchMutationScorer needs at least one read");
+    }
+    for (size_t n = 0; n < evaluators.size(); n += R::LANES) {
+        size_t end = std::min(evaluators.size(), n + R::LANES);
+        batches_.push_back(EvaluatorType(
+            std::vector<QvEvaluator>(evaluators.begin() + n, evaluators.begin() + end)));
+    }
+    for (size_t n = 1; n < evaluators.size(); n++) {
+        if (evaluators[n].Template() != evaluators[0].Template()) {
+            throw InvalidInputError("All reads in a batch must share one template");
+        }
+    }
+    Fill();
+}
+
+template <typename R>
+void BatchMutationScorer<R>::Fill()
+{
+    int J = batches_[0].MaxTemplateLength();
+
+    alphas_.clear();
+    betas_.clear();
+    extendBuffers_.clear();
+    scores_.clear();
+
+    for (size_t b = 0; b < batches_.size(); b++) {
+        int I = batches_[b].MaxReadLength();
+        alphas_.push_back(MatrixType(I + 1, J + 1));
+        betas_.push_back(MatrixType(I + 1, J + 1));
+        extendBuffers_.push_back(MatrixType(I + 1, EXTEND_BUFFER_COLUMNS));
+
+        std::vector<float> batchScores =
+            recursor_.FillAlphaBeta(batches_[b], alphas_.back(), betas_.back());
+        scores_.insert(scores_.end(), batchScores.begin(), batchScores.end());
+    }
+}
+
+template <typename R>
+int BatchMutationScorer<R>::NumReads() const
+{
+    return scores_.size();
+}
+
+template <typename R>
+std::string BatchMutationScorer<R>::Template() const
+{
+    return batches_[0].LaneTemplate(0);
+}
+
+template <typename R>
+void BatchMutationScorer<R>::Template(std::string tpl)
+{
+    for (size_t b = 0; b < batches_.size(); b++) {
+        batches_[b].Template(tpl);
+    }
+    Fill();
+}
+
+template <typename R>
+std::vector<float> BatchMutationScorer<R>::Scores() const
+{
+    return scores_;
+}
+
+template <typename R>
+std::vector<float> BatchMutationScorer<R>::ScoreMutation(const Mutation& m) const
+{
+    int betaLinkCol = 1 + m.End();
+    int absoluteLinkColumn = 1 + m.End() + m.LengthDiff();
+    std::string oldTpl = Template();
+    std::string newTpl = ApplyMutation(m, oldTpl);
+    int newJ = newTpl.length();
+
+    bool atBegin = (m.Start() < 3);
+    bool atEnd = (m.End() > static_cast<int>(oldTpl.length()) - 2);
+
+    std::vector<float> scores;
+    scores.reserve(NumReads());
+
+    for (size_t b = 0; b < batches_.size(); b++) {
+        EvaluatorType& e = batches_[b];
+        MatrixType& ext = extendBuffers_[b];
+        std::vector<float> batchScores;
+
+        // Install mutated template
+        e.Template(newTpl);
+
+        if (!atBegin && !atEnd) {
+            int extendStartCol, extendLength;
+
+            if (m.Type() == DELETION) {
+                extendStartCol = m.Start() - 1;
+                extendLength = 2;
+            } else {
+                extendStartCol = m.Start();
+                extendLength = 1 + m.NewBases().length();
+                assert(extendLength <= EXTEND_BUFFER_COLUMNS);
+            }
+
+            recursor_.ExtendAlpha(e, alphas_[b], extendStartCol, ext, extendLength);
+            batchScores = recursor_.LinkAlphaBeta(e, ext, extendLength, betas_[b], betaLinkCol,
+                                                  absoluteLinkColumn);
+        } else if (!atBegin && atEnd) {
+            //
+            // Extend alpha to end
+            //
+            int extendStartCol = m.Start() - 1;
+            int extendLength = newJ - extendStartCol + 1;
+            assert(extendLength <= EXTEND_BUFFER_COLUMNS);
+
+            recursor_.ExtendAlpha(e, alphas_[b], extendStartCol, ext, extendLength);
+            for (int k = 0; k < e.NumReads(); k++) {
+                batchScores.push_back(ext.Get(e.ReadLength(k), extendLength - 1, k));
+            }
+        } else {
+            //
+            // Just do the whole fill
+            //
+            MatrixType alphaP(alphas_[b].Rows(), newJ + 1);
+            recursor_.FillAlpha(e, InterleavedMatrix::Null(), alphaP);
+            for (int k = 0; k < e.NumReads(); k++) {
+                batchScores.push_back(alphaP.Get(e.ReadLength(k), newJ, k));
+            }
+        }
+
+        // Restore the original template.
+        e.Template(oldTpl);
+
+        scores.insert(scores.end(), batchScores.begin(), batchScores.end());
+    }
+
+    return scores;
+}
+
+template class BatchMutationScorer<BatchQvRecursor>;
+template class BatchMutationScorer<BatchQvSumProductRecursor>;
+}
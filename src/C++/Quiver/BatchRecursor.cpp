@@ -0,0 +1,499 @@
+#include <ConsensusCore/Quiver/BatchRecursor.hpp>
+
+#include <xmmintrin.h>
+
+#include <algorithm>
+#include <boost/tuple/tuple.hpp>
+#include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <vector>
+
+#include <ConsensusCore/Interval.hpp>
+#include <ConsensusCore/Matrix/InterleavedMatrix.hpp>
+#include <ConsensusCore/Quiver/InterleavedQvEvaluator.hpp>
+#include <ConsensusCore/Quiver/detail/Combiner.hpp>
+#include <ConsensusCore/Quiver/detail/SseMath.hpp>
+
+using std::min;
+using std::max;
+
+#define NEG_INF -FLT_MAX
+
+namespace ConsensusCore {
+
+namespace {
+
+// Lanes whose template reaches column j
+inline __m128 LanesAtColumn(int j, __m128 tplLengths4)
+{
+    return _mm_cmple_ps(_mm_set_ps1(static_cast<float>(j)), tplLengths4);
+}
+
+// Is any of the given lanes that owns row i within its band threshold?
+inline bool AnyLaneInBand(int i, __m128 lanes4, __m128 lengths4, __m128 score4, __m128 threshold4)
+{
+    __m128 live4 = _mm_and_ps(lanes4, _mm_cmple_ps(_mm_set_ps1(static_cast<float>(i)), lengths4));
+    __m128 inBand4 =
+        _mm_and_ps(_mm_cmpge_ps(score4, threshold4), _mm_cmpgt_ps(score4, _mm_set_ps1(NEG_INF)));
+    return _mm_movemask_ps(_mm_and_ps(live4, inBand4)) != 0;
+}
+
+// The rows of column j within ScoreDiff of their lane's best score; the
+// per-lane analogue of RowRange in RecursorBase-inl.hpp
+inline Interval LaneRowRange(int j, const InterleavedMatrix& matrix, __m128 lanes4, __m128 lengths4,
+                             float scoreDiff)
+{
+    int beginRow, endRow;
+    boost::tie(beginRow, endRow) = matrix.UsedRowRange(j);
+
+    __m128 maxScore4 = _mm_set_ps1(NEG_INF);
+    for (int i = beginRow; i < endRow; i++) {
+        maxScore4 = _mm_max_ps(maxScore4, matrix.Get4(i, j));
+    }
+    __m128 threshold4 = _mm_sub_ps(maxScore4, _mm_set_ps1(scoreDiff));
+
+    int i;
+    for (i = beginRow;
+         i < endRow - 1 && !AnyLaneInBand(i, lanes4, lengths4, matrix.Get4(i, j), threshold4); i++)
+        ;
+    beginRow = i;
+
+    for (i = endRow - 1;
+         i > beginRow && !AnyLaneInBand(i, lanes4, lengths4, matrix.Get4(i, j), threshold4); i--)
+        ;
+    endRow = i + 1;
+
+    return Interval(beginRow, endRow);
+}
+
+// Widen the hinted rows of column j to the bands of the guide and of the
+// matrix's previous fill, as RecursorBase::RangeGuide does
+inline void RangeGuide(int j, const InterleavedMatrix& guide, const InterleavedMatrix& matrix,
+                       __m128 lanes4, __m128 lengths4, float scoreDiff, int* beginRow, int* endRow)
+{
+    Interval interval(*beginRow, *endRow);
+    if (!(guide.IsNull() || guide.IsColumnEmpty(j))) {
+        interval = RangeUnion(LaneRowRange(j, guide, lanes4, lengths4, scoreDiff), interval);
+    }
+    if (!matrix.IsColumnEmpty(j)) {
+        interval = RangeUnion(LaneRowRange(j, matrix, lanes4, lengths4, scoreDiff), interval);
+    }
+    boost::tie(*beginRow, *endRow) = interval;
+}
+
+// Does any read's alpha(I_k, J_k) disagree with its beta(0, 0)?
+inline bool AnyLaneMismatched(const InterleavedQvEvaluator& e, const InterleavedMatrix& alpha,
+                              const InterleavedMatrix& beta, float tolerance)
+{
+    for (int k = 0; k < e.NumReads(); k++) {
+        float a = alpha.Get(e.ReadLength(k), e.TemplateLength(k), k);
+        if (std::fabs(a - beta.Get(0, 0, k)) > tolerance) return true;
+    }
+    return false;
+}
+
+// The last row (alpha) or first row (beta) any of the given lanes must reach
+inline int LongestRead(__m128 lanes4, __m128 lengths4)
+{
+    float v[InterleavedMatrix::LANES];
+    _mm_storeu_ps(v, MUX4(lanes4, lengths4, _mm_set_ps1(-1.0f)));
+    return static_cast<int>(*std::max_element(v, v + InterleavedMatrix::LANES));
+}
+
+inline int ShortestRead(__m128 lanes4, __m128 lengths4)
+{
+    float v[InterleavedMatrix::LANES];
+    _mm_storeu_ps(v, MUX4(lanes4, lengths4, _mm_set_ps1(FLT_MAX)));
+    return static_cast<int>(*std::min_element(v, v + InterleavedMatrix::LANES));
+}
+
+inline std::vector<float> Lanes(__m128 v4, int numLanes)
+{
+    float v[InterleavedMatrix::LANES];
+    _mm_storeu_ps(v, v4);
+    return std::vector<float>(v, v + numLanes);
+}
+}
+
+template <typename E, typename C>
+void BatchRecursor<E, C>::FillAlpha(const E& e, const InterleavedMatrix& guide,
+                                    InterleavedMatrix& alpha) const
+{
+    int I = e.MaxReadLength();
+    int J = e.MaxTemplateLength();
+
+    assert(alpha.Rows() == I + 1 && alpha.Columns() == J + 1);
+    assert(guide.IsNull() || (guide.Rows() == alpha.Rows() && guide.Columns() == alpha.Columns()));
+
+    const __m128 lengths4 = e.ReadLengths4();
+    const __m128 tplLengths4 = e.TemplateLengths4();
+    const __m128 negInf4 = _mm_set_ps1(NEG_INF);
+    const __m128 scoreDiff4 = _mm_set_ps1(bandingOptions_.ScoreDiff);
+
+    int hintBeginRow = 0, hintEndRow = 0;
+
+    for (int j = 0; j <= J; ++j) {
+        const __m128 lanes4 = LanesAtColumn(j, tplLengths4);
+        const bool allLanes =
+            (_mm_movemask_ps(lanes4) == _mm_movemask_ps(LanesAtColumn(0, tplLengths4)));
+        RangeGuide(j, guide, alpha, lanes4, lengths4, bandingOptions_.ScoreDiff, &hintBeginRow,
+                   &hintEndRow);
+
+        // A lane's last column is filled down to its last row, so that it
+        // reaches its end
+        const __m128 ends4 = _mm_cmpeq_ps(_mm_set_ps1(static_cast<float>(j)), tplLengths4);
+        int requiredEndRow = min(I + 1, hintEndRow);
+        if (_mm_movemask_ps(ends4)) {
+            requiredEndRow = max(requiredEndRow, LongestRead(ends4, lengths4) + 1);
+        }
+
+        alpha.StartEditingColumn(j, hintBeginRow, hintEndRow);
+
+        __m128 score4 = negInf4;
+        __m128 thresholdScore4 = negInf4;
+        __m128 maxScore4 = negInf4;
+        bool inBand = true;
+
+        int i, beginRow = hintBeginRow, endRow;
+        for (i = beginRow; i < I + 1 && (inBand || i < requiredEndRow); ++i) {
+            // score4 still holds alpha(i - 1, j)
+            __m128 prev4 = score4;
+            score4 = (i == 0 && j == 0) ? _mm_setzero_ps() : negInf4;
+
+            // Incorporation:
+            if (i > 0 && j > 0) {
+                score4 =
+                    C::Combine4(score4, _mm_add_ps(alpha.Get4(i - 1, j - 1), e.Inc4(i - 1, j - 1)));
+            }
+
+            // Extra:
+            if (i > 0) {
+                score4 = C::Combine4(score4, _mm_add_ps(prev4, e.Extra4(i - 1, j)));
+            }
+
+            // Delete:
+            if (j > 0) {
+                score4 = C::Combine4(score4, _mm_add_ps(alpha.Get4(i, j - 1), e.Del4(i, j - 1)));
+            }
+
+            // Merge:
+            if ((movesAvailable_ & MERGE) && j > 1 && i > 0) {
+                score4 = C::Combine4(score4,
+                                     _mm_add_ps(alpha.Get4(i - 1, j - 2), e.Merge4(i - 1, j - 2)));
+            }
+
+            // Keep unreachable cells at NEG_INF rather than letting them
+            // run off to -inf, and lanes past the end of their template
+            // empty
+            score4 = _mm_max_ps(score4, negInf4);
+            if (!allLanes) score4 = MUX4(lanes4, score4, negInf4);
+            alpha.Set4(i, j, score4);
+
+            maxScore4 = _mm_max_ps(maxScore4, score4);
+            thresholdScore4 = _mm_sub_ps(maxScore4, scoreDiff4);
+            inBand = AnyLaneInBand(i, lanes4, lengths4, score4, thresholdScore4);
+        }
+
+        endRow = i;
+        alpha.FinishEditingColumn(j, beginRow, endRow);
+
+        // Now, revise the hints to tell the caller where the mass of the
+        // distribution really lived in this column.
+        hintEndRow = endRow;
+        for (i = beginRow;
+             i < endRow && !AnyLaneInBand(i, lanes4, lengths4, alpha.Get4(i, j), thresholdScore4);
+             ++i)
+            ;
+        hintBeginRow = i;
+    }
+}
+
+template <typename E, typename C>
+void BatchRecursor<E, C>::FillBeta(const E& e, const InterleavedMatrix& guide,
+                                   InterleavedMatrix& beta) const
+{
+    int I = e.MaxReadLength();
+    int J = e.MaxTemplateLength();
+
+    assert(beta.Rows() == I + 1 && beta.Columns() == J + 1);
+    assert(guide.IsNull() || (guide.Rows() == beta.Rows() && guide.Columns() == beta.Columns()));
+
+    const __m128 lengths4 = e.ReadLengths4();
+    const __m128 tplLengths4 = e.TemplateLengths4();
+    const __m128 negInf4 = _mm_set_ps1(NEG_INF);
+    const __m128 scoreDiff4 = _mm_set_ps1(bandingOptions_.ScoreDiff);
+
+    int hintBeginRow = I + 1, hintEndRow = I + 1;
+
+    for (int j = J; j >= 0; --j) {
+        const __m128 lanes4 = LanesAtColumn(j, tplLengths4);
+        const bool allLanes =
+            (_mm_movemask_ps(lanes4) == _mm_movemask_ps(LanesAtColumn(0, tplLengths4)));
+        RangeGuide(j, guide, beta, lanes4, lengths4, bandingOptions_.ScoreDiff, &hintBeginRow,
+                   &hintEndRow);
+
+        // Lanes start in the last column of their template, at their last
+        // row, so that column is filled up from that row; the first column
+        // holds every lane's score and is filled completely.
+        const __m128 starts4 = _mm_cmpeq_ps(_mm_set_ps1(static_cast<float>(j)), tplLengths4);
+        bool laneStarts = _mm_movemask_ps(starts4);
+        int requiredBeginRow = (j == 0) ? 0 : max(0, hintBeginRow);
+        if (laneStarts) {
+            requiredBeginRow = min(requiredBeginRow, ShortestRead(starts4, lengths4));
+            hintEndRow = max(hintEndRow, LongestRead(starts4, lengths4) + 1);
+        }
+
+        beta.StartEditingColumn(j, hintBeginRow, hintEndRow);
+
+        __m128 score4 = negInf4;
+        __m128 thresholdScore4 = negInf4;
+        __m128 maxScore4 = negInf4;
+        bool inBand = true;
+
+        int i, beginRow, endRow = hintEndRow;
+        for (i = endRow - 1; i >= 0 && (inBand || i >= requiredBeginRow); --i) {
+            // score4 still holds beta(i + 1, j)
+            __m128 next4 = score4;
+            score4 = negInf4;
+
+            // Start:
+            if (laneStarts) {
+                __m128 start4 =
+                    _mm_and_ps(starts4, _mm_cmpeq_ps(_mm_set_ps1(static_cast<float>(i)), lengths4));
+                score4 = MUX4(start4, _mm_setzero_ps(), negInf4);
+            }
+
+            // Incorporation:
+            if (i < I && j < J) {
+                score4 = C::Combine4(score4, _mm_add_ps(beta.Get4(i + 1, j + 1), e.Inc4(i, j)));
+            }
+
+            // Extra:
+            if (i < I) {
+                score4 = C::Combine4(score4, _mm_add_ps(next4, e.Extra4(i, j)));
+            }
+
+            // Delete:
+            if (j < J) {
+                score4 = C::Combine4(score4, _mm_add_ps(beta.Get4(i, j + 1), e.Del4(i, j)));
+            }
+
+            // Merge:
+            if ((movesAvailable_ & MERGE) && j < J - 1 && i < I) {
+                score4 = C::Combine4(score4, _mm_add_ps(beta.Get4(i + 1, j + 2), e.Merge4(i, j)));
+            }
+
+            score4 = _mm_max_ps(score4, negInf4);
+            if (!allLanes) score4 = MUX4(lanes4, score4, negInf4);
+            beta.Set4(i, j, score4);
+
+            maxScore4 = _mm_max_ps(maxScore4, score4);
+            thresholdScore4 = _mm_sub_ps(maxScore4, scoreDiff4);
+            inBand = AnyLaneInBand(i, lanes4, lengths4, score4, thresholdScore4);
+        }
+
+        beginRow = i + 1;
+        beta.FinishEditingColumn(j, beginRow, endRow);
+
+        // Now, revise the hints to tell the caller where the mass of the
+        // distribution really lived in this column.
+        hintBeginRow = beginRow;
+        for (i = endRow;
+             i > beginRow &&
+             !AnyLaneInBand(i - 1, lanes4, lengths4, beta.Get4(i - 1, j), thresholdScore4);
+             --i)
+            ;
+        hintEndRow = i;
+    }
+}
+
+template <typename E, typename C>
+std::vector<float> BatchRecursor<E, C>::FillAlphaBeta(const E& e, InterleavedMatrix& alpha,
+                                                      InterleavedMatrix& beta,
+                                                      int* numFlipFlops) const
+{
+    const float tolerance = recursorConfig_.AlphaBetaMismatchTolerance;
+    int I = e.MaxReadLength();
+    int J = e.MaxTemplateLength();
+
+    FillAlpha(e, InterleavedMatrix::Null(), alpha);
+    FillBeta(e, alpha, beta);
+
+    int flipflops = 0;
+    int maxSize = static_cast<int>(
+        0.5 + static_cast<double>(recursorConfig_.RebandingThreshold) * LANES * (I + 1) * (J + 1));
+
+    // if we use too much space, do at least one more round
+    // to take advantage of rebanding
+    if (alpha.UsedEntries() >= maxSize || beta.UsedEntries() >= maxSize) {
+        FillAlpha(e, beta, alpha);
+        FillBeta(e, alpha, beta);
+        FillAlpha(e, beta, alpha);
+        flipflops += 3;
+    }
+
+    while (AnyLaneMismatched(e, alpha, beta, tolerance) &&
+           flipflops <= recursorConfig_.MaxFlipFlops) {
+        if (flipflops % 2 == 0) {
+            FillAlpha(e, beta, alpha);
+        } else {
+            FillBeta(e, alpha, beta);
+        }
+        flipflops++;
+    }
+
+    if (AnyLaneMismatched(e, alpha, beta, tolerance)) {
+        throw AlphaBetaMismatchException();
+    }
+
+    if (numFlipFlops != NULL) {
+        *numFlipFlops = flipflops;
+    }
+
+    return Lanes(beta.Get4(0, 0), e.NumReads());
+}
+
+template <typename E, typename C>
+std::vector<float> BatchRecursor<E, C>::LinkAlphaBeta(const E& e, const InterleavedMatrix& alpha,
+                                                      int alphaColumn,
+                                                      const InterleavedMatrix& beta, int betaColumn,
+                                                      int absoluteColumn) const
+{
+    assert(alphaColumn > 1 && absoluteColumn > 1);
+    assert(absoluteColumn < e.MaxTemplateLength());
+
+    const int I = alpha.Rows() - 1;
+
+    int usedBegin, usedEnd;
+    boost::tie(usedBegin, usedEnd) =
+        RangeUnion(alpha.UsedRowRange(alphaColumn - 2), alpha.UsedRowRange(alphaColumn - 1),
+                   beta.UsedRowRange(betaColumn), beta.UsedRowRange(betaColumn + 1));
+
+    __m128 v4 = _mm_set_ps1(NEG_INF);
+
+    for (int i = usedBegin; i < usedEnd; i++) {
+        if (i < I) {
+            // Incorporate
+            __m128 move4 = e.Inc4(i, absoluteColumn - 1);
+            __m128 path4 = _mm_add_ps(_mm_add_ps(alpha.Get4(i, alphaColumn - 1), move4),
+                                      beta.Get4(i + 1, betaColumn));
+            v4 = C::Combine4(v4, path4);
+
+            // Merge (2 possible ways):
+            move4 = e.Merge4(i, absoluteColumn - 2);
+            path4 = _mm_add_ps(_mm_add_ps(alpha.Get4(i, alphaColumn - 2), move4),
+                               beta.Get4(i + 1, betaColumn));
+            v4 = C::Combine4(v4, path4);
+
+            move4 = e.Merge4(i, absoluteColumn - 1);
+            path4 = _mm_add_ps(_mm_add_ps(alpha.Get4(i, alphaColumn - 1), move4),
+                               beta.Get4(i + 1, betaColumn + 1));
+            v4 = C::Combine4(v4, path4);
+        }
+
+        // Delete:
+        __m128 move4 = e.Del4(i, absoluteColumn - 1);
+        __m128 path4 =
+            _mm_add_ps(_mm_add_ps(alpha.Get4(i, alphaColumn - 1), move4), beta.Get4(i, betaColumn));
+        v4 = C::Combine4(v4, path4);
+    }
+
+    return Lanes(_mm_max_ps(v4, _mm_set_ps1(NEG_INF)), e.NumReads());
+}
+
+//
+// Reads: alpha(:, (beginColumn-2)..)
+//
+template <typename E, typename C>
+void BatchRecursor<E, C>::ExtendAlpha(const E& e, const InterleavedMatrix& alpha, int beginColumn,
+                                      InterleavedMatrix& ext, int numExtColumns) const
+{
+    assert(numExtColumns >= 2);
+    assert(ext.Rows() == alpha.Rows());
+
+    const int I = alpha.Rows() - 1;
+    const int J = e.MaxTemplateLength();
+
+    // The new template may not be the same length as the old template.
+    // Just make sure that we have anough room to fill out the extend buffer
+    assert(beginColumn + 1 < J + 1);
+    assert(ext.Columns() >= numExtColumns);
+    assert(beginColumn >= 2);
+
+    const __m128 negInf4 = _mm_set_ps1(NEG_INF);
+
+    for (int extCol = 0; extCol < numExtColumns; extCol++) {
+        int j = beginColumn + extCol;
+        int beginRow, endRow;
+
+        //
+        // If this extend is contained within the column bounds of
+        // the original alpha, we use the row range that was
+        // previously determined.  Otherwise start at alpha's last
+        // UsedRow beginRow and go to the end.  The last column of
+        // the new template always runs to the end, where each lane
+        // reads off its score.
+        //
+        if (j < alpha.Columns()) {
+            boost::tie(beginRow, endRow) = alpha.UsedRowRange(j);
+        } else {
+            beginRow = alpha.UsedRowRange(alpha.Columns() - 1).Begin;
+            endRow = alpha.Rows();
+        }
+        if (j == J) {
+            endRow = I + 1;
+        }
+
+        ext.StartEditingColumn(extCol, beginRow, endRow);
+
+        __m128 score4 = negInf4;
+
+        for (int i = beginRow; i < endRow; i++) {
+            __m128 prev4 = score4;
+            score4 = negInf4;
+
+            // Incorporation:
+            if (i > 0 && j > 0) {
+                __m128 diag4 =
+                    (extCol == 0 ? alpha.Get4(i - 1, j - 1) : ext.Get4(i - 1, extCol - 1));
+                __m128 move4 = e.Inc4(i - 1, j - 1);
+                score4 = C::Combine4(score4, _mm_add_ps(diag4, move4));
+            }
+
+            // Extra:
+            if (i > 0) {
+                __m128 move4 = e.Extra4(i - 1, j);
+                score4 = C::Combine4(score4, _mm_add_ps(prev4, move4));
+            }
+
+            // Delete:
+            if (j > 0) {
+                __m128 left4 = (extCol == 0 ? alpha.Get4(i, j - 1) : ext.Get4(i, extCol - 1));
+                __m128 move4 = e.Del4(i, j - 1);
+                score4 = C::Combine4(score4, _mm_add_ps(left4, move4));
+            }
+
+            // Merge, reading alpha as SimpleRecursor::ExtendAlpha does:
+            if ((movesAvailable_ & MERGE) && j > 1 && i > 0) {
+                __m128 move4 = e.Merge4(i - 1, j - 2);
+                score4 = C::Combine4(score4, _mm_add_ps(alpha.Get4(i - 1, j - 2), move4));
+            }
+
+            score4 = _mm_max_ps(score4, negInf4);
+            ext.Set4(i, extCol, score4);
+        }
+        ext.FinishEditingColumn(extCol, beginRow, endRow);
+    }
+}
+
+template <typename E, typename C>
+BatchRecursor<E, C>::BatchRecursor(int movesAvailable, const BandingOptions& banding,
+                                   const RecursorConfig& config)
+    : movesAvailable_(movesAvailable), bandingOptions_(banding), recursorConfig_(config)
+{
+}
+
+template class BatchRecursor<InterleavedQvEvaluator, detail::ViterbiCombiner>;
+template class BatchRecursor<InterleavedQvEvaluator, detail::SumProductCombiner>;
+}
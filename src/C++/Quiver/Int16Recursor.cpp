@@ -0,0 +1,372 @@
+#include <ConsensusCore/Quiver/Int16Recursor.hpp>
+
+#include <emmintrin.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include <ConsensusCore/Matrix/Int16Matrix.hpp>
+#include <ConsensusCore/Quiver/QuantizedQvEvaluator.hpp>
+#include <ConsensusCore/Quiver/QvEvaluator.hpp>
+#include <ConsensusCore/Quiver/detail/Combiner.hpp>
+
+using std::max;
+using std::min;
+
+namespace ConsensusCore {
+
+namespace {
+
+const int16_t EMPTY_CELL = Int16Matrix::EMPTY_CELL;
+
+inline int16_t AddSaturate(int a, int b)
+{
+    return static_cast<int16_t>(max(-32768, min(32767, a + b)));
+}
+
+inline int16_t HorizontalMax8(__m128i v)
+{
+    v = _mm_max_epi16(v, _mm_srli_si128(v, 8));
+    v = _mm_max_epi16(v, _mm_srli_si128(v, 4));
+    v = _mm_max_epi16(v, _mm_srli_si128(v, 2));
+    return static_cast<int16_t>(_mm_extract_epi16(v, 0));
+}
+
+inline int16_t HorizontalMin8(__m128i v)
+{
+    v = _mm_min_epi16(v, _mm_srli_si128(v, 8));
+    v = _mm_min_epi16(v, _mm_srli_si128(v, 4));
+    v = _mm_min_epi16(v, _mm_srli_si128(v, 2));
+    return static_cast<int16_t>(_mm_extract_epi16(v, 0));
+}
+
+// s[k] = max(x[k], s[k - 1] + a[k]), with s[-1] = carry.  Lanes shifted in
+// from below are empty for s and zero for the running sums of a.
+inline __m128i PrefixScan8(__m128i x, __m128i a, int16_t carry)
+{
+    const __m128i empty1 = _mm_setr_epi16(EMPTY_CELL, 0, 0, 0, 0, 0, 0, 0);
+    const __m128i empty2 = _mm_setr_epi16(EMPTY_CELL, EMPTY_CELL, 0, 0, 0, 0, 0, 0);
+    const __m128i empty4 =
+        _mm_setr_epi16(EMPTY_CELL, EMPTY_CELL, EMPTY_CELL, EMPTY_CELL, 0, 0, 0, 0);
+    __m128i b = x;
+
+    b = _mm_max_epi16(b, _mm_adds_epi16(_mm_or_si128(_mm_slli_si128(b, 2), empty1), a));
+    a = _mm_adds_epi16(a, _mm_slli_si128(a, 2));
+    b = _mm_max_epi16(b, _mm_adds_epi16(_mm_or_si128(_mm_slli_si128(b, 4), empty2), a));
+    a = _mm_adds_epi16(a, _mm_slli_si128(a, 4));
+    b = _mm_max_epi16(b, _mm_adds_epi16(_mm_or_si128(_mm_slli_si128(b, 8), empty4), a));
+    a = _mm_adds_epi16(a, _mm_slli_si128(a, 8));
+
+    return _mm_max_epi16(b, _mm_adds_epi16(_mm_set1_epi16(carry), a));
+}
+
+// s[k] = max(x[k], s[k + 1] + a[k]), with s[8] = carry.
+inline __m128i SuffixScan8(__m128i x, __m128i a, int16_t carry)
+{
+    const __m128i empty1 = _mm_setr_epi16(0, 0, 0, 0, 0, 0, 0, EMPTY_CELL);
+    const __m128i empty2 = _mm_setr_epi16(0, 0, 0, 0, 0, 0, EMPTY_CELL, EMPTY_CELL);
+    const __m128i empty4 =
+        _mm_setr_epi16(0, 0, 0, 0, EMPTY_CELL, EMPTY_CELL, EMPTY_CELL, EMPTY_CELL);
+    __m128i b = x;
+
+    b = _mm_max_epi16(b, _mm_adds_epi16(_mm_or_si128(_mm_srli_si128(b, 2), empty1), a));
+    a = _mm_adds_epi16(a, _mm_srli_si128(a, 2));
+    b = _mm_max_epi16(b, _mm_adds_epi16(_mm_or_si128(_mm_srli_si128(b, 4), empty2), a));
+    a = _mm_adds_epi16(a, _mm_srli_si128(a, 4));
+    b = _mm_max_epi16(b, _mm_adds_epi16(_mm_or_si128(_mm_srli_si128(b, 8), empty4), a));
+    a = _mm_adds_epi16(a, _mm_srli_si128(a, 8));
+
+    return _mm_max_epi16(b, _mm_adds_epi16(_mm_set1_epi16(carry), a));
+}
+
+// Rebase the n cells of a column from the frame they were filled in onto
+// the column's maximum.  Cells below FLOOR, either before or after, are
+// emptied.
+void Renormalize(int16_t* column, int n, int16_t maxScore)
+{
+    const __m128i floor8 = _mm_set1_epi16(Int16Matrix::FLOOR - 1);
+    const __m128i max8 = _mm_set1_epi16(maxScore);
+    const __m128i empty8 = _mm_set1_epi16(EMPTY_CELL);
+
+    int k = 0;
+    for (; k + 8 <= n; k += 8) {
+        __m128i* p = reinterpret_cast<__m128i*>(column + k);
+        __m128i x = _mm_loadu_si128(p);
+        __m128i y = _mm_subs_epi16(x, max8);
+        __m128i keep = _mm_and_si128(_mm_cmpgt_epi16(x, floor8), _mm_cmpgt_epi16(y, floor8));
+        _mm_storeu_si128(p, _mm_or_si128(_mm_and_si128(keep, y), _mm_andnot_si128(keep, empty8)));
+    }
+    for (; k < n; k++) {
+        int y = column[k] - maxScore;
+        bool keep = (column[k] >= Int16Matrix::FLOOR && y >= Int16Matrix::FLOOR);
+        column[k] = keep ? static_cast<int16_t>(y) : EMPTY_CELL;
+    }
+}
+
+// Finish a column filled in the frame of base: check that its band fits in
+// int16, renormalize it, and store it.  False if it does not fit.
+bool StoreColumn(Int16Matrix& m, int j, int scale, int base, int16_t* column, int beginRow,
+                 int endRow, int maxScore, int scoreDiff)
+{
+    if (maxScore < Int16Matrix::FLOOR) {
+        // Nothing in the column can be reached
+        std::fill(column + beginRow, column + endRow, EMPTY_CELL);
+        maxScore = 0;
+    } else if (maxScore - scoreDiff < Int16Matrix::FLOOR) {
+        return false;
+    } else {
+        Renormalize(column + beginRow, endRow - beginRow, static_cast<int16_t>(maxScore));
+    }
+    m.SetQuantizedColumn(j, scale, base + maxScore, beginRow, endRow, column + beginRow);
+    return true;
+}
+
+// Running maximum and block minimum of the cells filled so far in a column
+struct ColumnScores
+{
+    int Max;
+    int Threshold;
+    int Score;
+
+    explicit ColumnScores(int scoreDiff)
+        : Max(EMPTY_CELL), Threshold(EMPTY_CELL), Score(EMPTY_CELL), scoreDiff_(scoreDiff)
+    {
+    }
+
+    void Update(int blockMax, int blockMin)
+    {
+        Score = blockMin;
+        if (blockMax > Max) {
+            Max = blockMax;
+            Threshold = Max - scoreDiff_;
+        }
+    }
+
+    // Cells first .. first + rows - 1 of a block of eight, the rest of which
+    // is outside the matrix
+    void Update(__m128i v, const int16_t* block, int first, int rows)
+    {
+        if (first == 0 && rows == QuantizedQvEvaluator::LANES) {
+            Update(HorizontalMax8(v), HorizontalMin8(v));
+        } else {
+            int16_t blockMax = *std::max_element(block + first, block + first + rows);
+            int16_t blockMin = *std::min_element(block + first, block + first + rows);
+            Update(blockMax, blockMin);
+        }
+    }
+
+private:
+    int scoreDiff_;
+};
+}
+
+bool Int16QvRecursor::QuantizedFillAlpha(const QvEvaluator& ev, const Int16Matrix& guide,
+                                         const std::vector<Interval>& bandSeed,
+                                         Int16Matrix& alpha) const
+{
+    const int W = QuantizedQvEvaluator::LANES;
+    const int scale = Int16Matrix::ScaleFor(bandingOptions_.ScoreDiff);
+    if (scale == 0) return false;
+
+    QuantizedQvEvaluator e(ev, scale);
+    int I = e.ReadLength();
+    int J = e.TemplateLength();
+    bool useMerge = (movesAvailable_ & MERGE);
+    int scoreDiff = static_cast<int>(bandingOptions_.ScoreDiff * scale + 0.5f);
+
+    assert(alpha.Rows() == I + 1 && alpha.Columns() == J + 1);
+    assert(guide.IsNull() || (guide.Rows() == alpha.Rows() && guide.Columns() == alpha.Columns()));
+
+    if (!e.IsQuantizable()) return false;
+
+    // The column being filled, with a block of padding past either end
+    std::vector<int16_t> buffer(I + 1 + 2 * W);
+    int16_t* column = &buffer[W];
+
+    int hintBeginRow = 0, hintEndRow = 0;
+
+    for (int j = 0; j <= J; ++j) {
+        RangeGuide(j, guide, alpha, bandSeed, &hintBeginRow, &hintEndRow);
+
+        int requiredEndRow = min(I + 1, hintEndRow);
+
+        // Column j is filled relative to the base of column j - 1
+        int base = (j > 0) ? alpha.Base(j - 1) : 0;
+        int mergeDelta = (j > 1) ? alpha.Base(j - 2) - base : 0;
+        if (mergeDelta >= -Int16Matrix::FLOOR) return false;
+        __m128i mergeDelta8 = _mm_set1_epi16(static_cast<int16_t>(max(-32768, mergeDelta)));
+
+        ColumnScores scores(scoreDiff);
+        int16_t carry = EMPTY_CELL;
+        int beginRow = hintBeginRow, endRow;
+        int i = beginRow;
+
+        // Row 0 is reached only by deletions
+        if (i == 0) {
+            int16_t score =
+                (j == 0) ? 0 : AddSaturate(alpha.GetQuantized(0, j - 1), e.Del(0, j - 1));
+            column[0] = carry = score;
+            scores.Update(score, score);
+            i++;
+        }
+
+        for (; i <= I && (scores.Score >= scores.Threshold || i < requiredEndRow); i += W) {
+            __m128i score8 = _mm_set1_epi16(EMPTY_CELL);
+            if (j > 0) {
+                // Incorporation
+                score8 = _mm_max_epi16(score8, _mm_adds_epi16(alpha.GetQuantized8(i - 1, j - 1),
+                                                              e.Inc8(i - 1, j - 1)));
+                // Deletion
+                score8 = _mm_max_epi16(
+                    score8, _mm_adds_epi16(alpha.GetQuantized8(i, j - 1), e.Del8(i, j - 1)));
+            }
+            // Merge
+            if (useMerge && j > 1) {
+                __m128i prev8 = _mm_adds_epi16(alpha.GetQuantized8(i - 1, j - 2), mergeDelta8);
+                score8 = _mm_max_epi16(score8, _mm_adds_epi16(prev8, e.Merge8(i - 1, j - 2)));
+            }
+            // Extra (prefix scan down the block)
+            score8 = PrefixScan8(score8, e.Extra8(i - 1, j), carry);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(column + i), score8);
+            carry = column[i + W - 1];
+            scores.Update(score8, column + i, 0, min(W, I + 1 - i));
+        }
+
+        endRow = min(i, I + 1);
+        if (!StoreColumn(alpha, j, scale, base, column, beginRow, endRow, scores.Max, scoreDiff)) {
+            return false;
+        }
+
+        // Now, revise the hints to tell the caller where the mass of the
+        // distribution really lived in this column.
+        hintEndRow = endRow;
+        for (i = beginRow; i < endRow && column[i] < -scoreDiff; ++i)
+            ;
+        hintBeginRow = i;
+    }
+    return true;
+}
+
+bool Int16QvRecursor::QuantizedFillBeta(const QvEvaluator& ev, const Int16Matrix& guide,
+                                        Int16Matrix& beta) const
+{
+    const int W = QuantizedQvEvaluator::LANES;
+    const int scale = Int16Matrix::ScaleFor(bandingOptions_.ScoreDiff);
+    if (scale == 0) return false;
+
+    QuantizedQvEvaluator e(ev, scale);
+    int I = e.ReadLength();
+    int J = e.TemplateLength();
+    bool useMerge = (movesAvailable_ & MERGE);
+    int scoreDiff = static_cast<int>(bandingOptions_.ScoreDiff * scale + 0.5f);
+
+    assert(beta.Rows() == I + 1 && beta.Columns() == J + 1);
+    assert(guide.IsNull() || (guide.Rows() == beta.Rows() && guide.Columns() == beta.Columns()));
+
+    if (!e.IsQuantizable()) return false;
+
+    std::vector<int16_t> buffer(I + 1 + 2 * W);
+    int16_t* column = &buffer[W];
+
+    int hintBeginRow = I + 1, hintEndRow = I + 1;
+
+    for (int j = J; j >= 0; --j) {
+        RangeGuide(j, guide, beta, &hintBeginRow, &hintEndRow);
+
+        int requiredBeginRow = max(0, hintBeginRow);
+
+        // Column j is filled relative to the base of column j + 1
+        int base = (j < J) ? beta.Base(j + 1) : 0;
+        int mergeDelta = (j < J - 1) ? beta.Base(j + 2) - base : 0;
+        if (mergeDelta >= -Int16Matrix::FLOOR) return false;
+        __m128i mergeDelta8 = _mm_set1_epi16(static_cast<int16_t>(max(-32768, mergeDelta)));
+
+        ColumnScores scores(scoreDiff);
+        int16_t carry = EMPTY_CELL;
+        int beginRow, endRow = hintEndRow;
+        int i = endRow - 1;
+
+        // Row I is reached only by deletions
+        if (i == I) {
+            int16_t score = (j == J) ? 0 : AddSaturate(beta.GetQuantized(I, j + 1), e.Del(I, j));
+            column[I] = carry = score;
+            scores.Update(score, score);
+            i--;
+        }
+
+        // Blocks run from row i - W + 1 up to row i
+        for (; i >= 0 && (scores.Score >= scores.Threshold || i >= requiredBeginRow); i -= W) {
+            int lo = i - W + 1;
+            __m128i score8 = _mm_set1_epi16(EMPTY_CELL);
+            if (j < J) {
+                // Incorporation
+                score8 = _mm_max_epi16(
+                    score8, _mm_adds_epi16(beta.GetQuantized8(lo + 1, j + 1), e.Inc8(lo, j)));
+                // Deletion
+                score8 = _mm_max_epi16(
+                    score8, _mm_adds_epi16(beta.GetQuantized8(lo, j + 1), e.Del8(lo, j)));
+            }
+            // Merge
+            if (useMerge && j < J - 1) {
+                __m128i next8 = _mm_adds_epi16(beta.GetQuantized8(lo + 1, j + 2), mergeDelta8);
+                score8 = _mm_max_epi16(score8, _mm_adds_epi16(next8, e.Merge8(lo, j)));
+            }
+            // Extra (suffix scan up the block)
+            score8 = SuffixScan8(score8, e.Extra8(lo, j), carry);
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(column + lo), score8);
+            carry = column[lo];
+            int first = max(0, -lo);
+            scores.Update(score8, column + lo, first, W - first);
+        }
+
+        beginRow = max(0, i + 1);
+        if (!StoreColumn(beta, j, scale, base, column, beginRow, endRow, scores.Max, scoreDiff)) {
+            return false;
+        }
+
+        // Now, revise the hints to tell the caller where the mass of the
+        // distribution really lived in this column.
+        hintBeginRow = beginRow;
+        for (i = endRow; i > beginRow && column[i - 1] < -scoreDiff; i--)
+            ;
+        hintEndRow = i;
+    }
+    return true;
+}
+
+void Int16QvRecursor::FillAlpha(const QvEvaluator& e, const Int16Matrix& guide,
+                                Int16Matrix& alpha) const
+{
+    if (!QuantizedFillAlpha(e, guide, std::vector<Interval>(), alpha)) {
+        SseRecursor<Int16Matrix, QvEvaluator, detail::ViterbiCombiner>::FillAlpha(e, guide, alpha);
+    }
+}
+
+void Int16QvRecursor::FillAlpha(const QvEvaluator& e, const std::vector<Interval>& bandSeed,
+                                Int16Matrix& alpha) const
+{
+    if (!QuantizedFillAlpha(e, Int16Matrix::Null(), bandSeed, alpha)) {
+        SseRecursor<Int16Matrix, QvEvaluator, detail::ViterbiCombiner>::FillAlpha(e, bandSeed,
+                                                                                  alpha);
+    }
+}
+
+void Int16QvRecursor::FillBeta(const QvEvaluator& e, const Int16Matrix& guide,
+                               Int16Matrix& beta) const
+{
+    if (!QuantizedFillBeta(e, guide, beta)) {
+        SseRecursor<Int16Matrix, QvEvaluator, detail::ViterbiCombiner>::FillBeta(e, guide, beta);
+    }
+}
+
+Int16QvRecursor::Int16QvRecursor(int movesAvailable, const BandingOptions& banding,
+                                 const RecursorConfig& config)
+    : SseRecursor<Int16Matrix, QvEvaluator, detail::ViterbiCombiner>(movesAvailable, banding,
+                                                                     config)
+{
+}
+}
@@ -1,7 +1,12 @@
 // Author: David Alexander
 
 #include <ConsensusCore/Checksum.hpp>
+#include <ConsensusCore/Matrix/InterleavedMatrix.hpp>
+#include <ConsensusCore/Matrix/SparseMatrix.hpp>
 #include <ConsensusCore/Mutation.hpp>
+#include <ConsensusCore/Quiver/BandSeed.hpp>
+#include <ConsensusCore/Quiver/BatchRecursor.hpp>
+#include <ConsensusCore/Quiver/InterleavedQvEvaluator.hpp>
 #include <ConsensusCore/Quiver/MultiReadMutationScorer.hpp>
 #include <ConsensusCore/Quiver/MutationScorer.hpp>
 #include <ConsensusCore/Sequence.hpp>
@@ -17,6 +22,68 @@
 #define MIN_FAVORABLE_SCOREDIFF 0.04f  // Chosen such that 0.49 = 1 / (1 + exp(minScoreDiff))
 
 namespace ConsensusCore {
+namespace {
+
+// Consecutive reads of one chemistry, at most a batch's worth at a time
+std::vector<std::vector<MappedRead> > ChemistryBatches(const std::vector<MappedRead>& mrs)
+{
+    std::vector<std::vector<MappedRead> > batches;
+    for (size_t n = 0; n < mrs.size(); n++) {
+        if (batches.empty() ||
+            batches.back().size() == static_cast<size_t>(InterleavedQvEvaluator::LANES) ||
+            batches.back()[0].Chemistry != mrs[n].Chemistry) {
+            batches.push_back(std::vector<MappedRead>());
+        }
+        batches.back().push_back(mrs[n]);
+    }
+    return batches;
+}
+
+// Scorers for a batch of reads filled together by the BatchRecursor
+// counterpart of R, each with its own copy of its lane of the matrices.
+// Returns false, leaving scorers empty, when R has no counterpart.
+template <typename R>
+struct BatchFill
+{
+    static bool Scorers(const std::vector<typename R::EvaluatorType>&, const QuiverConfig&,
+                        std::vector<MutationScorer<R>*>*)
+    {
+        return false;
+    }
+};
+
+template <typename C>
+struct BatchFill<SseRecursor<SparseMatrix, QvEvaluator, C> >
+{
+    typedef SseRecursor<SparseMatrix, QvEvaluator, C> R;
+
+    static bool Scorers(const std::vector<QvEvaluator>& evs, const QuiverConfig& config,
+                        std::vector<MutationScorer<R>*>* scorers)
+    {
+        BatchRecursor<InterleavedQvEvaluator, C> batchRecursor(config.MovesAvailable,
+                                                               config.Banding, config.Recursor);
+        InterleavedQvEvaluator batch(evs);
+        int I = batch.MaxReadLength();
+        int J = batch.MaxTemplateLength();
+        InterleavedMatrix alpha(I + 1, J + 1), beta(I + 1, J + 1);
+        int flipflops;
+        batchRecursor.FillAlphaBeta(batch, alpha, beta, &flipflops);
+
+        R recursor(config.MovesAvailable, config.Banding, config.Recursor);
+        for (size_t k = 0; k < evs.size(); k++) {
+            int Ik = evs[k].ReadLength();
+            int Jk = evs[k].TemplateLength();
+            SparseMatrix* a = new SparseMatrix(Ik + 1, Jk + 1);
+            SparseMatrix* b = new SparseMatrix(Ik + 1, Jk + 1);
+            alpha.CopyLane(k, config.Banding.ScoreDiff, *a);
+            beta.CopyLane(k, config.Banding.ScoreDiff, *b);
+            scorers->push_back(new MutationScorer<R>(evs[k], recursor, a, b, flipflops));
+        }
+        return true;
+    }
+};
+}
+
 //
 // Could the mutation change the contents of the portion of the
 // template that is mapped to the read?
@@ -158,15 +225,32 @@ void MultiReadMutationScorer<R>::ApplyMutations(const std::vector<Mutation>& mut
 
     foreach (ReadStateType& rs, reads_) {
         try {
-            int newTemplateStart = mtp[rs.Read->TemplateStart];
-            int newTemplateEnd = mtp[rs.Read->TemplateEnd];
+            int oldTemplateStart = rs.Read->TemplateStart;
+            int oldTemplateEnd = rs.Read->TemplateEnd;
+            int newTemplateStart = mtp[oldTemplateStart];
+            int newTemplateEnd = mtp[oldTemplateEnd];
 
             // reads (even inactive reads) will have their mapping coords updated
             rs.Read->TemplateStart = newTemplateStart;
             rs.Read->TemplateEnd = newTemplateEnd;
 
-            if (rs.IsActive) {
-                rs.Scorer->Template(Template(rs.Read->Strand, newTemplateStart, newTemplateEnd));
+            if (!rs.IsActive) continue;
+
+            std::string tpl = Template(rs.Read->Strand, newTemplateStart, newTemplateEnd);
+            if (quiverConfigByChemistry_.At(rs.Read->Chemistry).Recursor.SeedRefills) {
+                // Seed the refill with the old band, column-mapped onto the new template
+                int oldColumns = oldTemplateEnd - oldTemplateStart + 1;
+                std::vector<int> newColumnOf(oldColumns);
+                for (int j = 0; j < oldColumns; j++) {
+                    newColumnOf[j] = (rs.Read->Strand == FORWARD_STRAND)
+                                         ? mtp[oldTemplateStart + j] - newTemplateStart
+                                         : newTemplateEnd - mtp[oldTemplateEnd - j];
+                }
+                std::vector<Interval> bandSeed = RemapBandSeed(
+                    *rs.Scorer->Alpha(), newColumnOf, newTemplateEnd - newTemplateStart + 1);
+                rs.Scorer->Template(tpl, bandSeed);
+            } else {
+                rs.Scorer->Template(tpl);
             }
         } catch (AlphaBetaMismatchException& e) {
             rs.IsActive = false;
@@ -181,7 +265,7 @@ bool MultiReadMutationScorer<R>::AddRead(const MappedRead& mr, float threshold)
     DEBUG_ONLY(CheckInvariants());
     const QuiverConfig* config = &quiverConfigByChemistry_.At(mr.Chemistry);
     EvaluatorType ev(mr, Template(mr.Strand, mr.TemplateStart, mr.TemplateEnd), config->QvParams);
-    RecursorType recursor(config->MovesAvailable, config->Banding);
+    RecursorType recursor(config->MovesAvailable, config->Banding, config->Recursor);
 
     ScorerType* scorer;
     try {
@@ -190,9 +274,82 @@ bool MultiReadMutationScorer<R>::AddRead(const MappedRead& mr, float threshold)
         scorer = NULL;
     }
 
+    bool isActive = AddScorer(mr, scorer, threshold);
+    DEBUG_ONLY(CheckInvariants());
+    return isActive;
+}
+
+template <typename R>
+bool MultiReadMutationScorer<R>::AddRead(const MappedRead& mr)
+{
+    DEBUG_ONLY(CheckInvariants());
+    const QuiverConfig* config = &quiverConfigByChemistry_.At(mr.Chemistry);
+    return AddRead(mr, config->AddThreshold);
+}
+
+template <typename R>
+std::vector<bool> MultiReadMutationScorer<R>::AddReads(const std::vector<MappedRead>& mrs,
+                                                       float threshold)
+{
+    std::vector<bool> isActive;
+    foreach (const std::vector<MappedRead>& batch, ChemistryBatches(mrs)) {
+        AddReadBatch(batch, threshold, &isActive);
+    }
+    return isActive;
+}
+
+template <typename R>
+std::vector<bool> MultiReadMutationScorer<R>::AddReads(const std::vector<MappedRead>& mrs)
+{
+    std::vector<bool> isActive;
+    foreach (const std::vector<MappedRead>& batch, ChemistryBatches(mrs)) {
+        const QuiverConfig* config = &quiverConfigByChemistry_.At(batch[0].Chemistry);
+        AddReadBatch(batch, config->AddThreshold, &isActive);
+    }
+    return isActive;
+}
+
+template <typename R>
+void MultiReadMutationScorer<R>::AddReadBatch(const std::vector<MappedRead>& batch, float threshold,
+                                              std::vector<bool>* isActive)
+{
+    DEBUG_ONLY(CheckInvariants());
+    const QuiverConfig* config = &quiverConfigByChemistry_.At(batch[0].Chemistry);
+    std::vector<EvaluatorType> evs;
+    foreach (const MappedRead& mr, batch) {
+        evs.push_back(EvaluatorType(mr, Template(mr.Strand, mr.TemplateStart, mr.TemplateEnd),
+                                    config->QvParams));
+    }
+
+    std::vector<ScorerType*> scorers;
+    bool batched;
+    try {
+        batched = BatchFill<R>::Scorers(evs, *config, &scorers);
+    } catch (AlphaBetaMismatchException& e) {
+        // One read failing to converge should not cost the others theirs
+        batched = false;
+    }
+
+    if (!batched) {
+        foreach (const MappedRead& mr, batch) {
+            isActive->push_back(AddRead(mr, threshold));
+        }
+        return;
+    }
+
+    for (size_t k = 0; k < batch.size(); k++) {
+        isActive->push_back(AddScorer(batch[k], scorers[k], threshold));
+    }
+    DEBUG_ONLY(CheckInvariants());
+}
+
+template <typename R>
+bool MultiReadMutationScorer<R>::AddScorer(const MappedRead& mr, ScorerType* scorer,
+                                           float threshold)
+{
     if (scorer != NULL && threshold < 1.0f) {
-        int I = ev.ReadLength();
-        int J = ev.TemplateLength();
+        int I = scorer->Evaluator()->ReadLength();
+        int J = scorer->Evaluator()->TemplateLength();
         int maxSize = static_cast<int>(0.5f + threshold * (I + 1) * (J + 1));
 
         if (scorer->Alpha()->AllocatedEntries() >= maxSize ||
@@ -204,18 +361,9 @@ bool MultiReadMutationScorer<R>::AddRead(const MappedRead& mr, float threshold)
 
     bool isActive = scorer != NULL;
     reads_.push_back(ReadStateType(new MappedRead(mr), scorer, isActive));
-    DEBUG_ONLY(CheckInvariants());
     return isActive;
 }
 
-template <typename R>
-bool MultiReadMutationScorer<R>::AddRead(const MappedRead& mr)
-{
-    DEBUG_ONLY(CheckInvariants());
-    const QuiverConfig* config = &quiverConfigByChemistry_.At(mr.Chemistry);
-    return AddRead(mr, config->AddThreshold);
-}
-
 template <typename R>
 float MultiReadMutationScorer<R>::Score(const Mutation& m) const
 {
@@ -455,4 +603,7 @@ std::string ReadState<ScorerType>::ToString() const
 
 template class MultiReadMutationScorer<SparseSseQvRecursor>;
 template class MultiReadMutationScorer<SparseSseQvSumProductRecursor>;
+template class MultiReadMutationScorer<Int16QvRecursor>;
+template class MultiReadMutationScorer<HalfSseQvRecursor>;
+template class MultiReadMutationScorer<HalfSseQvSumProductRecursor>;
 }
@@ -10,6 +10,7 @@
 #include <ConsensusCore/Quiver/SimpleRecursor.hpp>
 #include <ConsensusCore/Quiver/SseRecursor.hpp>
 
+#include <cassert>
 #include <string>
 
 #define EXTEND_BUFFER_COLUMNS 8
@@ -36,6 +37,20 @@ MutationScorer<R>::MutationScorer(const EvaluatorType& evaluator, const R& recur
     }
 }
 
+template <typename R>
+MutationScorer<R>::MutationScorer(const EvaluatorType& evaluator, const R& recursor,
+                                  MatrixType* alpha, MatrixType* beta, int numFlipFlops)
+    : evaluator_(new EvaluatorType(evaluator))
+    , recursor_(new R(recursor))
+    , alpha_(alpha)
+    , beta_(beta)
+    , extendBuffer_(new MatrixType(evaluator.ReadLength() + 1, EXTEND_BUFFER_COLUMNS))
+    , numFlipFlops_(numFlipFlops)
+{
+    assert(alpha->Rows() == evaluator.ReadLength() + 1 &&
+           alpha->Columns() == evaluator.TemplateLength() + 1);
+}
+
 template <typename R>
 MutationScorer<R>::MutationScorer(const MutationScorer<R>& other)
 {
@@ -64,13 +79,19 @@ std::string MutationScorer<R>::Template() const
 
 template <typename R>
 void MutationScorer<R>::Template(std::string tpl)
+{
+    Template(tpl, std::vector<Interval>());
+}
+
+template <typename R>
+void MutationScorer<R>::Template(std::string tpl, const std::vector<Interval>& bandSeed)
 {
     delete alpha_;
     delete beta_;
     evaluator_->Template(tpl);
     alpha_ = new MatrixType(evaluator_->ReadLength() + 1, evaluator_->TemplateLength() + 1);
     beta_ = new MatrixType(evaluator_->ReadLength() + 1, evaluator_->TemplateLength() + 1);
-    recursor_->FillAlphaBeta(*evaluator_, *alpha_, *beta_);
+    numFlipFlops_ = recursor_->FillAlphaBeta(*evaluator_, *alpha_, *beta_, bandSeed);
 }
 
 template <typename R>
@@ -194,4 +215,7 @@ template class MutationScorer<SparseSimpleQvSumProductRecursor>;
 template class MutationScorer<SparseSseQvRecursor>;
 template class MutationScorer<SparseSseQvSumProductRecursor>;
 template class MutationScorer<SparseSseEdnaRecursor>;
+template class MutationScorer<Int16QvRecursor>;
+template class MutationScorer<HalfSseQvRecursor>;
+template class MutationScorer<HalfSseQvSumProductRecursor>;
 }
@@ -11,12 +11,13 @@
 namespace ConsensusCore {
 QuiverConfig::QuiverConfig(const QvModelParams& qvParams, int movesAvailable,
                            const BandingOptions& bandingOptions, float fastScoreThreshold,
-                           float addThreshold)
+                           float addThreshold, const RecursorConfig& recursorConfig)
     : QvParams(qvParams)
     , MovesAvailable(movesAvailable)
     , Banding(bandingOptions)
     , FastScoreThreshold(fastScoreThreshold)
     , AddThreshold(addThreshold)
+    , Recursor(recursorConfig)
 {
 }
 
@@ -26,6 +27,7 @@ QuiverConfig::QuiverConfig(const QuiverConfig& qvConfig)
     , Banding(qvConfig.Banding)
     , FastScoreThreshold(qvConfig.FastScoreThreshold)
     , AddThreshold(qvConfig.AddThreshold)
+    , Recursor(qvConfig.Recursor)
 {
 }
 
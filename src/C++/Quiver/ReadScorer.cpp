@@ -20,7 +20,8 @@ ReadScorer::ReadScorer(QuiverConfig& config) : _quiverConfig(config) {}
 float ReadScorer::Score(const string& tpl, const Read& read) const
 {
     int I, J;
-    SparseSseQvRecursor r(_quiverConfig.MovesAvailable, _quiverConfig.Banding);
+    SparseSseQvRecursor r(_quiverConfig.MovesAvailable, _quiverConfig.Banding,
+                          _quiverConfig.Recursor);
     QvEvaluator e(read, tpl, _quiverConfig.QvParams);
 
     I = read.Length();
@@ -34,7 +35,8 @@ float ReadScorer::Score(const string& tpl, const Read& read) const
 const PairwiseAlignment* ReadScorer::Align(const string& tpl, const Read& read) const
 {
     int I, J;
-    SparseSseQvRecursor r(_quiverConfig.MovesAvailable, _quiverConfig.Banding);
+    SparseSseQvRecursor r(_quiverConfig.MovesAvailable, _quiverConfig.Banding,
+                          _quiverConfig.Recursor);
     QvEvaluator e(read, tpl, _quiverConfig.QvParams);
 
     I = read.Length();
@@ -47,7 +49,8 @@ const PairwiseAlignment* ReadScorer::Align(const string& tpl, const Read& read)
 const SparseMatrix* ReadScorer::Alpha(const string& tpl, const Read& read) const
 {
     int I, J;
-    SparseSseQvRecursor r(_quiverConfig.MovesAvailable, _quiverConfig.Banding);
+    SparseSseQvRecursor r(_quiverConfig.MovesAvailable, _quiverConfig.Banding,
+                          _quiverConfig.Recursor);
     QvEvaluator e(read, tpl, _quiverConfig.QvParams);
 
     I = read.Length();
@@ -61,7 +64,8 @@ const SparseMatrix* ReadScorer::Alpha(const string& tpl, const Read& read) const
 const SparseMatrix* ReadScorer::Beta(const string& tpl, const Read& read) const
 {
     int I, J;
-    SparseSseQvRecursor r(_quiverConfig.MovesAvailable, _quiverConfig.Banding);
+    SparseSseQvRecursor r(_quiverConfig.MovesAvailable, _quiverConfig.Banding,
+                          _quiverConfig.Recursor);
     QvEvaluator e(read, tpl, _quiverConfig.QvParams);
 
     I = read.Length();
@@ -0,0 +1,24 @@
+#include <ConsensusCore/Quiver/SimdLevel.hpp>
+
+#include <ConsensusCore/Quiver/detail/SseMath.hpp>
+
+namespace ConsensusCore {
+
+namespace {
+SimdLevel ProbeSimdLevel()
+{
+#ifdef CC_SIMD_DISPATCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SIMD_AVX512;
+    if (__builtin_cpu_supports("avx2")) return SIMD_AVX2;
+#endif  // CC_SIMD_DISPATCH
+    return SIMD_SSE;
+}
+}
+
+SimdLevel DetectSimdLevel()
+{
+    static const SimdLevel level = ProbeSimdLevel();
+    return level;
+}
+}
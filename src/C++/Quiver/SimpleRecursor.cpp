@@ -15,6 +15,7 @@
 #include <boost/tuple/tuple.hpp>
 #include <climits>
 #include <utility>
+#include <vector>
 
 using std::min;
 using std::max;
@@ -25,6 +26,20 @@ namespace ConsensusCore {
 
 template <typename M, typename E, typename C>
 void SimpleRecursor<M, E, C>::FillAlpha(const E& e, const M& guide, M& alpha) const
+{
+    FillAlpha(e, guide, std::vector<Interval>(), alpha);
+}
+
+template <typename M, typename E, typename C>
+void SimpleRecursor<M, E, C>::FillAlpha(const E& e, const std::vector<Interval>& bandSeed,
+                                        M& alpha) const
+{
+    FillAlpha(e, M::Null(), bandSeed, alpha);
+}
+
+template <typename M, typename E, typename C>
+void SimpleRecursor<M, E, C>::FillAlpha(const E& e, const M& guide,
+                                        const std::vector<Interval>& bandSeed, M& alpha) const
 {
     int I = e.ReadLength();
     int J = e.TemplateLength();
@@ -35,7 +50,7 @@ void SimpleRecursor<M, E, C>::FillAlpha(const E& e, const M& guide, M& alpha) co
     int hintBeginRow = 0, hintEndRow = 0;
 
     for (int j = 0; j <= J; ++j) {
-        this->RangeGuide(j, guide, alpha, &hintBeginRow, &hintEndRow);
+        this->RangeGuide(j, guide, alpha, bandSeed, &hintBeginRow, &hintEndRow);
 
         int requiredEndRow = min(I + 1, hintEndRow);
 
@@ -389,8 +404,9 @@ void SimpleRecursor<M, E, C>::ExtendBeta(const E& e, const M& beta, int lastColu
 }
 
 template <typename M, typename E, typename C>
-SimpleRecursor<M, E, C>::SimpleRecursor(int movesAvailable, const BandingOptions& banding)
-    : detail::RecursorBase<M, E, C>(movesAvailable, banding)
+SimpleRecursor<M, E, C>::SimpleRecursor(int movesAvailable, const BandingOptions& banding,
+                                        const RecursorConfig& config)
+    : detail::RecursorBase<M, E, C>(movesAvailable, banding, config)
 {
 }
 
@@ -4,11 +4,13 @@
 
 #include <ConsensusCore/Edna/EdnaEvaluator.hpp>
 #include <ConsensusCore/Interval.hpp>
+#include <ConsensusCore/Matrix/CompactSparseMatrix.hpp>
 #include <ConsensusCore/Matrix/DenseMatrix.hpp>
+#include <ConsensusCore/Matrix/Int16Matrix.hpp>
 #include <ConsensusCore/Matrix/SparseMatrix.hpp>
 #include <ConsensusCore/Quiver/QvEvaluator.hpp>
-#include <ConsensusCore/Quiver/SimpleRecursor.hpp>
 #include <ConsensusCore/Quiver/detail/Combiner.hpp>
+#include <ConsensusCore/Quiver/detail/SimdLanes.hpp>
 #include <ConsensusCore/Utils.hpp>
 
 #include <algorithm>
@@ -16,6 +18,9 @@
 #include <climits>
 #include <numeric>
 #include <utility>
+#include <vector>
+
+#include "detail/SimdKernels.hpp"
 
 using std::max;
 using std::min;
@@ -26,250 +31,134 @@ using std::min;
 
 namespace ConsensusCore {
 
+#ifdef CC_SIMD_DISPATCH
+// The wide kernels are instantiated in their own translation units, which are
+// compiled for the corresponding instruction set.
+#define CC_EXTERN_SIMD_KERNELS(V)                                            \
+    extern template struct detail::SimdKernels<V, DenseMatrix, QvEvaluator,  \
+                                               detail::ViterbiCombiner>;     \
+    extern template struct detail::SimdKernels<V, SparseMatrix, QvEvaluator, \
+                                               detail::ViterbiCombiner>;     \
+    extern template struct detail::SimdKernels<V, SparseMatrix, QvEvaluator, \
+                                               detail::SumProductCombiner>;
+
+CC_EXTERN_SIMD_KERNELS(detail::Simd8)
+CC_EXTERN_SIMD_KERNELS(detail::Simd16)
+#undef CC_EXTERN_SIMD_KERNELS
+#endif  // CC_SIMD_DISPATCH
+
 // MSVC dones't appear to have this defined.
 #ifdef _MSC_VER
 static inline __m128 operator+(const __m128 a, const __m128 b) { return _mm_add_ps(a, b); }
 #endif
 
-template <typename M, typename E, typename C>
-void SseRecursor<M, E, C>::FillAlpha(const E& e, const M& guide, M& alpha) const
+namespace {
+// Picks the fill kernel for a SIMD level.  Types without wide accessors only
+// have the SSE kernels, so they never name a wide instantiation.
+template <typename M, typename E, typename C, bool Wide = detail::HasWideAccessors<M, E>::value>
+struct KernelDispatch
 {
-    int I = e.ReadLength();
-    int J = e.TemplateLength();
-
-    assert(alpha.Rows() == I + 1 && alpha.Columns() == J + 1);
-    assert(guide.IsNull() || (guide.Rows() == alpha.Rows() && guide.Columns() == alpha.Columns()));
-
-    int hintBeginRow = 0, hintEndRow = 0;
-
-    for (int j = 0; j <= J; ++j) {
-        this->RangeGuide(j, guide, alpha, &hintBeginRow, &hintEndRow);
-
-        int requiredEndRow = min(I + 1, hintEndRow);
-
-        float score = NEG_INF;
-        float thresholdScore = NEG_INF;
-        float maxScore = NEG_INF;
+    static SimdLevel Clamp(SimdLevel) { return SIMD_SSE; }
+
+    static void FillAlpha(SimdLevel, const detail::RecursorBase<M, E, C>& r, int moves,
+                          float scoreDiff, const E& e, const M& guide,
+                          const std::vector<Interval>& bandSeed, M& alpha)
+    {
+        detail::SimdKernels<detail::Simd4, M, E, C>::FillAlpha(r, moves, scoreDiff, e, guide,
+                                                               bandSeed, alpha);
+    }
 
-        alpha.StartEditingColumn(j, hintBeginRow, hintEndRow);
+    static void FillBeta(SimdLevel, const detail::RecursorBase<M, E, C>& r, int moves,
+                         float scoreDiff, const E& e, const M& guide, M& beta)
+    {
+        detail::SimdKernels<detail::Simd4, M, E, C>::FillBeta(r, moves, scoreDiff, e, guide, beta);
+    }
+};
 
-        int i;
-        int beginRow = hintBeginRow, endRow;
-        // Handle beginning rows non-SSE.  Must handle row 0 this
-        // way (if row 0 is to be filled), and must terminate with
-        // (I - i + 1) divisible by 4, so that the SSE loop can
-        // run safely to the end.  Banding optimizations not applied
-        // here.
-        //
-        // TODO(dalexander): we could also handle the first two columns this way,
-        // and then we could remove all the conditionals from the SSE loop.
-        // Profile first.
-        //
-        for (i = beginRow; (i == 0 || (I - i + 1) % 4 != 0) && i <= I; i++) {
-            score = NEG_INF;
+// The level used when none is requested.  The wide Viterbi kernels bench no
+// faster than SSE on banded fills; the wide log-add pays for itself.
+template <typename C>
+SimdLevel DefaultSimdLevel()
+{
+    return SIMD_SSE;
+}
 
-            // Start:
-            if (i == 0 && j == 0) {
-                score = 0.0f;
-            }
-            // Inc
-            if (i > 0 && j > 0) {
-                score = C::Combine(score, alpha(i - 1, j - 1) + e.Inc(i - 1, j - 1));
-            }
-            // Merge
-            if ((this->movesAvailable_ & MERGE) && (i > 0 && j > 1)) {
-                score = C::Combine(score, alpha(i - 1, j - 2) + e.Merge(i - 1, j - 2));
-            }
-            // Delete
-            if (j > 0) {
-                score = C::Combine(score, alpha(i, j - 1) + e.Del(i, j - 1));
-            }
-            // Extra
-            if (i > 0) {
-                score = C::Combine(score, alpha(i - 1, j) + e.Extra(i - 1, j));
-            }
-            alpha.Set(i, j, score);
+template <>
+SimdLevel DefaultSimdLevel<detail::SumProductCombiner>()
+{
+    return DetectSimdLevel();
+}
 
-            if (score > maxScore) {
-                maxScore = score;
-                thresholdScore = maxScore - this->bandingOptions_.ScoreDiff;
-            }
+template <typename M, typename E, typename C>
+struct KernelDispatch<M, E, C, true>
+{
+    static SimdLevel Clamp(SimdLevel level) { return std::min(level, DetectSimdLevel()); }
+
+    static void FillAlpha(SimdLevel level, const detail::RecursorBase<M, E, C>& r, int moves,
+                          float scoreDiff, const E& e, const M& guide,
+                          const std::vector<Interval>& bandSeed, M& alpha)
+    {
+        switch (level) {
+#ifdef CC_SIMD_DISPATCH
+            case SIMD_AVX512:
+                detail::SimdKernels<detail::Simd16, M, E, C>::FillAlpha(r, moves, scoreDiff, e,
+                                                                        guide, bandSeed, alpha);
+                break;
+            case SIMD_AVX2:
+                detail::SimdKernels<detail::Simd8, M, E, C>::FillAlpha(r, moves, scoreDiff, e,
+                                                                       guide, bandSeed, alpha);
+                break;
+#endif  // CC_SIMD_DISPATCH
+            default:
+                detail::SimdKernels<detail::Simd4, M, E, C>::FillAlpha(r, moves, scoreDiff, e,
+                                                                       guide, bandSeed, alpha);
         }
-        //
-        // Main SSE loop
-        //
-        assert(i > 0);
-        for (; i <= I && (score >= thresholdScore || i < requiredEndRow); i += 4) {
-            __m128 score4 = NEG_INF_4;
-            // Incorporation:
-            if (j > 0) {
-                score4 = C::Combine4(score4, alpha.Get4(i - 1, j - 1) + e.Inc4(i - 1, j - 1));
-            }
-            // Merge
-            if ((this->movesAvailable_ & MERGE) && j >= 2) {
-                score4 = C::Combine4(score4, alpha.Get4(i - 1, j - 2) + e.Merge4(i - 1, j - 2));
-            }
-            // Deletion:
-            if (j > 0) {
-                score4 = C::Combine4(score4, alpha.Get4(i, j - 1) + e.Del4(i, j - 1));
-            }
-
-            //
-            // Extra (non-SSE cascade)
-            //
-            float insScores4_[4], score5_[5];
-
-            __m128 insScores4 = e.Extra4(i - 1, j);
-            _mm_storeu_ps(insScores4_, insScores4);
-
-            score5_[0] = alpha.Get(i - 1, j);
-            _mm_storeu_ps(&score5_[1], score4);
-
-            for (int ii = 1; ii < 5; ii++) {
-                float v = C::Combine(score5_[ii], score5_[ii - 1] + insScores4_[ii - 1]);
-                score5_[ii] = v;
-            }
-            score4 = _mm_loadu_ps(&score5_[1]);
-            alpha.Set4(i, j, score4);
-
-            // Update score, potentialNewMax
-            float potentialNewMax = *std::max_element(score5_ + 1, score5_ + 5);
-            score = *std::min_element(score5_ + 1, score5_ + 5);
+    }
 
-            if (potentialNewMax > maxScore) {
-                maxScore = potentialNewMax;
-                thresholdScore = maxScore - this->bandingOptions_.ScoreDiff;
-            }
+    static void FillBeta(SimdLevel level, const detail::RecursorBase<M, E, C>& r, int moves,
+                         float scoreDiff, const E& e, const M& guide, M& beta)
+    {
+        switch (level) {
+#ifdef CC_SIMD_DISPATCH
+            case SIMD_AVX512:
+                detail::SimdKernels<detail::Simd16, M, E, C>::FillBeta(r, moves, scoreDiff, e,
+                                                                       guide, beta);
+                break;
+            case SIMD_AVX2:
+                detail::SimdKernels<detail::Simd8, M, E, C>::FillBeta(r, moves, scoreDiff, e, guide,
+                                                                      beta);
+                break;
+#endif  // CC_SIMD_DISPATCH
+            default:
+                detail::SimdKernels<detail::Simd4, M, E, C>::FillBeta(r, moves, scoreDiff, e, guide,
+                                                                      beta);
         }
-
-        endRow = i;
-        alpha.FinishEditingColumn(j, beginRow, endRow);
-
-        // Now, revise the hints to tell the caller where the mass of the
-        // distribution really lived in this column.
-        hintEndRow = endRow;
-        for (i = beginRow; i < endRow && alpha(i, j) < thresholdScore; ++i)
-            ;
-        hintBeginRow = i;
     }
+};
 }
 
 template <typename M, typename E, typename C>
-void SseRecursor<M, E, C>::FillBeta(const E& e, const M& guide, M& beta) const
+void SseRecursor<M, E, C>::FillAlpha(const E& e, const M& guide, M& alpha) const
 {
-    int I = e.ReadLength();
-    int J = e.TemplateLength();
-
-    assert(beta.Rows() == I + 1 && beta.Columns() == J + 1);
-    assert(guide.IsNull() || (guide.Rows() == beta.Rows() && guide.Columns() == beta.Columns()));
-
-    int hintBeginRow = I + 1, hintEndRow = I + 1;
-
-    for (int j = J; j >= 0; --j) {
-        this->RangeGuide(j, guide, beta, &hintBeginRow, &hintEndRow);
-
-        int requiredBeginRow = max(0, hintBeginRow);
-
-        float score = NEG_INF;
-        float thresholdScore = NEG_INF;
-        float maxScore = NEG_INF;
-
-        beta.StartEditingColumn(j, hintBeginRow, hintEndRow);
-        //
-        // See comment in FillAlpha---we are doing the same thing here.
-        // An initial non-SSE loop, terminating when a multiple of 4
-        // rows remain.
-        //
-        int i, beginRow, endRow = hintEndRow;
-        for (i = endRow - 1; (i == I || (i + 1) % 4 != 0) && i >= 0; i--) {
-            score = NEG_INF;
-
-            // Start:
-            if (i == I && j == J) {
-                score = 0.0f;
-            }
-            // Inc
-            if (i < I && j < J) {
-                score = C::Combine(score, beta(i + 1, j + 1) + e.Inc(i, j));
-            }
-            // Merge
-            if ((this->movesAvailable_ & MERGE) && j < J - 1 && i < I) {
-                score = C::Combine(score, beta(i + 1, j + 2) + e.Merge(i, j));
-            }
-            // Delete
-            if (j < J) {
-                score = C::Combine(score, beta(i, j + 1) + e.Del(i, j));
-            }
-            // Extra
-            if (i < I) {
-                score = C::Combine(score, beta(i + 1, j) + e.Extra(i, j));
-            }
-
-            beta.Set(i, j, score);
-
-            if (score > maxScore) {
-                maxScore = score;
-                thresholdScore = maxScore - this->bandingOptions_.ScoreDiff;
-            }
-        }
-        //
-        // SSE loop
-        //
-        i = i - 3;
-        for (; i >= 0 && (score >= thresholdScore || i >= requiredBeginRow); i -= 4) {
-            __m128 score4 = NEG_INF_4;
-
-            // Incorporation:
-            if (i < I && j < J) {
-                score4 = C::Combine4(score4, beta.Get4(i + 1, j + 1) + e.Inc4(i, j));
-            }
-            // Merge
-            if ((this->movesAvailable_ & MERGE) && j < J - 1 && i < I) {
-                score4 = C::Combine4(score4, beta.Get4(i + 1, j + 2) + e.Merge4(i, j));
-            }
-            // Deletion:
-            if (j < J) {
-                score4 = C::Combine4(score4, beta.Get4(i, j + 1) + e.Del4(i, j));
-            }
-
-            //
-            // Extra (non-SSE cascade)
-            //
-            float insScores4_[4], score5_[5];
-
-            __m128 insScores4 = e.Extra4(i, j);
-            _mm_storeu_ps(insScores4_, insScores4);
-
-            score5_[4] = beta.Get(i + 4, j);
-            _mm_storeu_ps(score5_, score4);
-
-            for (int ii = 3; ii >= 0; ii--) {
-                float v = C::Combine(score5_[ii], score5_[ii + 1] + insScores4_[ii]);
-                score5_[ii] = v;
-            }
-            score4 = _mm_loadu_ps(score5_);
-            beta.Set4(i, j, score4);
-
-            // Update score, potentialNewMax
-            float potentialNewMax = *std::max_element(score5_, score5_ + 4);
-            score = *std::min_element(score5_, score5_ + 4);
-
-            if (potentialNewMax > maxScore) {
-                maxScore = potentialNewMax;
-                thresholdScore = maxScore - this->bandingOptions_.ScoreDiff;
-            }
-        }
+    KernelDispatch<M, E, C>::FillAlpha(simdLevel_, *this, this->movesAvailable_,
+                                       this->bandingOptions_.ScoreDiff, e, guide,
+                                       std::vector<Interval>(), alpha);
+}
 
-        beginRow = i + 4;
-        beta.FinishEditingColumn(j, beginRow, endRow);
+template <typename M, typename E, typename C>
+void SseRecursor<M, E, C>::FillAlpha(const E& e, const std::vector<Interval>& bandSeed,
+                                     M& alpha) const
+{
+    KernelDispatch<M, E, C>::FillAlpha(simdLevel_, *this, this->movesAvailable_,
+                                       this->bandingOptions_.ScoreDiff, e, M::Null(), bandSeed,
+                                       alpha);
+}
 
-        // Now, revise the hints to tell the caller where the mass of the
-        // distribution really lived in this column.
-        hintBeginRow = beginRow;
-        for (i = endRow; i > beginRow && beta(i - 1, j) < thresholdScore; i--)
-            ;
-        hintEndRow = i;
-    }
+template <typename M, typename E, typename C>
+void SseRecursor<M, E, C>::FillBeta(const E& e, const M& guide, M& beta) const
+{
+    KernelDispatch<M, E, C>::FillBeta(simdLevel_, *this, this->movesAvailable_,
+                                      this->bandingOptions_.ScoreDiff, e, guide, beta);
 }
 
 template <typename M, typename E, typename C>
@@ -409,43 +298,131 @@ INLINE_CALLEES void SseRecursor<M, E, C>::ExtendAlpha(const E& e, const M& alpha
             score4 = C::Combine4(score4, prev4 + e.Del4(i, j - 1));
 
             // Extras:
-            float insScores4_[4], score5_[5];
+            score4 = detail::prefixScan4<C>(score4, e.Extra4(i - 1, j), ext.Get(i - 1, extCol));
+            ext.Set4(i, extCol, score4);
+        }
+        assert(i == endRow);
+
+        ext.FinishEditingColumn(extCol, beginRow, endRow);
+    }
+}
+
+template <typename M, typename E, typename C>
+INLINE_CALLEES void SseRecursor<M, E, C>::ExtendBeta(const E& e, const M& beta, int lastColumn,
+                                                     M& ext, int numExtColumns,
+                                                     int lengthDiff) const
+{
+    int I = beta.Rows() - 1;
+    int J = beta.Columns() - 1;
 
-            __m128 insScores4 = e.Extra4(i - 1, j);
-            _mm_storeu_ps(insScores4_, insScores4);
+    int lastExtColumn = numExtColumns - 1;
 
-            score5_[0] = ext.Get(i - 1, extCol);
-            _mm_storeu_ps(&score5_[1], score4);
+    assert(beta.Rows() == I + 1 && ext.Rows() == I + 1);
 
-            for (int ii = 1; ii < 5; ii++) {
-                float v = C::Combine(score5_[ii], score5_[ii - 1] + insScores4_[ii - 1]);
-                score5_[ii] = v;
+    // The new template may not be the same length as the old template.
+    // Just make sure that we have anough room to fill out the extend buffer
+    assert(lastColumn + 2 <= J);
+    assert(lastColumn >= 0);
+    assert(ext.Columns() >= numExtColumns);
+
+    for (int j = lastColumn; j > lastColumn - numExtColumns; j--) {
+        int jp = j + lengthDiff;
+        int extCol = lastExtColumn - (lastColumn - j);
+        int beginRow, endRow;
+
+        if (j < 0) {
+            beginRow = 0;
+            endRow = beta.UsedRowRange(0).End;
+        } else {
+            boost::tie(beginRow, endRow) = beta.UsedRowRange(j);
+        }
+
+        ext.StartEditingColumn(extCol, beginRow, endRow);
+        int i;
+        // Handle the last rows non-SSE, leaving a multiple of 4
+        // entries to be handed off to the SSE loop.  Need to always
+        // handle row I this way, so that we don't have to check for
+        // (i < I) in the SSE loop.
+        for (i = endRow - 1; (i == I || (i - beginRow + 1) % 4 != 0) && i >= beginRow; i--) {
+            float prev, score = NEG_INF;
+
+            // Incorporation:
+            if (i < I && j < J) {
+                prev = (extCol == lastExtColumn) ? beta(i + 1, j + 1) : ext(i + 1, extCol + 1);
+                score = C::Combine(score, prev + e.Inc(i, jp));
+            }
+            // Merge:
+            if ((this->movesAvailable_ & MERGE) && j < J - 1 && i < I) {
+                score = C::Combine(score, beta(i + 1, j + 2) + e.Merge(i, jp));
             }
-            score4 = _mm_loadu_ps(&score5_[1]);
+            // Delete:
+            if (j < J) {
+                prev = (extCol == lastExtColumn) ? beta(i, j + 1) : ext(i, extCol + 1);
+                score = C::Combine(score, prev + e.Del(i, jp));
+            }
+            // Extra:
+            if (i < I) {
+                score = C::Combine(score, ext(i + 1, extCol) + e.Extra(i, jp));
+            }
+            ext.Set(i, extCol, score);
+        }
+        for (i -= 3; i >= beginRow; i -= 4) {
+            __m128 prev4, score4 = NEG_INF_4;
+
+            if (j < J) {
+                // Incorporation:
+                prev4 = (extCol == lastExtColumn) ? beta.Get4(i + 1, j + 1)
+                                                  : ext.Get4(i + 1, extCol + 1);
+                score4 = C::Combine4(score4, prev4 + e.Inc4(i, jp));
+
+                // Merge:
+                if ((this->movesAvailable_ & MERGE) && j < J - 1) {
+                    prev4 = beta.Get4(i + 1, j + 2);
+                    score4 = C::Combine4(score4, prev4 + e.Merge4(i, jp));
+                }
+
+                // Deletion:
+                prev4 = (extCol == lastExtColumn) ? beta.Get4(i, j + 1) : ext.Get4(i, extCol + 1);
+                score4 = C::Combine4(score4, prev4 + e.Del4(i, jp));
+            }
+
+            // Extras:
+            score4 = detail::suffixScan4<C>(score4, e.Extra4(i, jp), ext.Get(i + 4, extCol));
             ext.Set4(i, extCol, score4);
         }
-        assert(i == endRow);
+        assert(i == beginRow - 4);
 
         ext.FinishEditingColumn(extCol, beginRow, endRow);
     }
 }
 
 template <typename M, typename E, typename C>
-void SseRecursor<M, E, C>::ExtendBeta(const E& e, const M& beta, int endColumn, M& ext,
-                                      int numExtColumns, int lengthDiff) const
+SseRecursor<M, E, C>::SseRecursor(int movesAvailable, const BandingOptions& banding,
+                                  const RecursorConfig& config)
+    : detail::RecursorBase<M, E, C>(movesAvailable, banding, config)
+    , simdLevel_(KernelDispatch<M, E, C>::Clamp(DefaultSimdLevel<C>()))
+{
+}
+
+template <typename M, typename E, typename C>
+SseRecursor<M, E, C>::SseRecursor(int movesAvailable, const BandingOptions& banding,
+                                  SimdLevel simdLevel, const RecursorConfig& config)
+    : detail::RecursorBase<M, E, C>(movesAvailable, banding, config)
+    , simdLevel_(KernelDispatch<M, E, C>::Clamp(simdLevel))
 {
-    simpleRecursor_.ExtendBeta(e, beta, endColumn, ext, numExtColumns, lengthDiff);
 }
 
 template <typename M, typename E, typename C>
-SseRecursor<M, E, C>::SseRecursor(int movesAvailable, const BandingOptions& banding)
-    : detail::RecursorBase<M, E, C>(movesAvailable, banding)
-    , simpleRecursor_(movesAvailable, banding)
+SimdLevel SseRecursor<M, E, C>::Simd() const
 {
+    return simdLevel_;
 }
 
 template class SseRecursor<DenseMatrix, QvEvaluator, detail::ViterbiCombiner>;
 template class SseRecursor<SparseMatrix, QvEvaluator, detail::ViterbiCombiner>;
 template class SseRecursor<SparseMatrix, QvEvaluator, detail::SumProductCombiner>;
 template class SseRecursor<SparseMatrix, EdnaEvaluator, detail::SumProductCombiner>;
+template class SseRecursor<Int16Matrix, QvEvaluator, detail::ViterbiCombiner>;
+template class SseRecursor<HalfSparseMatrix, QvEvaluator, detail::ViterbiCombiner>;
+template class SseRecursor<HalfSparseMatrix, QvEvaluator, detail::SumProductCombiner>;
 }
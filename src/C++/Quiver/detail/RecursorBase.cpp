@@ -6,7 +6,9 @@
 #include <ConsensusCore/Edna/EdnaEvaluator.hpp>
 #include <ConsensusCore/LFloat.hpp>
 #include <ConsensusCore/Logging.hpp>
+#include <ConsensusCore/Matrix/CompactSparseMatrix.hpp>
 #include <ConsensusCore/Matrix/DenseMatrix.hpp>
+#include <ConsensusCore/Matrix/Int16Matrix.hpp>
 #include <ConsensusCore/Matrix/SparseMatrix.hpp>
 #include <ConsensusCore/Quiver/QuiverConfig.hpp>
 #include <ConsensusCore/Quiver/QvEvaluator.hpp>
@@ -19,11 +21,6 @@
 #include <string>
 #include <vector>
 
-// TODO(dalexander): put these into a RecursorConfig struct
-#define MAX_FLIP_FLOPS 5
-#define ALPHA_BETA_MISMATCH_TOLERANCE 0.2f
-#define REBANDING_THRESHOLD 0.04
-
 using std::max;
 using std::min;
 
@@ -33,13 +30,28 @@ namespace detail {
 template <typename M, typename E, typename C>
 int RecursorBase<M, E, C>::FillAlphaBeta(const E& e, M& a, M& b) const
 {
-    FillAlpha(e, M::Null(), a);
-    FillBeta(e, a, b);
+    return FillAlphaBeta(e, a, b, std::vector<Interval>());
+}
 
+template <typename M, typename E, typename C>
+int RecursorBase<M, E, C>::FillAlphaBeta(const E& e, M& a, M& b,
+                                         const std::vector<Interval>& bandSeed) const
+{
     int I = e.ReadLength();
     int J = e.TemplateLength();
+
+    if (bandSeed.empty()) {
+        FillAlpha(e, M::Null(), a);
+    } else {
+        assert(static_cast<int>(bandSeed.size()) == J + 1);
+        FillAlpha(e, bandSeed, a);
+    }
+    FillBeta(e, a, b);
+
+    const float tolerance = recursorConfig_.AlphaBetaMismatchTolerance;
     int flipflops = 0;
-    int maxSize = static_cast<int>(0.5 + REBANDING_THRESHOLD * (I + 1) * (J + 1));
+    int maxSize = static_cast<int>(
+        0.5 + static_cast<double>(recursorConfig_.RebandingThreshold) * (I + 1) * (J + 1));
 
     // if we use too much space, do at least one more round
     // to take advantage of rebanding
@@ -50,8 +62,7 @@ int RecursorBase<M, E, C>::FillAlphaBeta(const E& e, M& a, M& b) const
         flipflops += 3;
     }
 
-    while (std::fabs(a(I, J) - b(0, 0)) > ALPHA_BETA_MISMATCH_TOLERANCE &&
-           flipflops <= MAX_FLIP_FLOPS) {
+    while (std::fabs(a(I, J) - b(0, 0)) > tolerance && flipflops <= recursorConfig_.MaxFlipFlops) {
         if (flipflops % 2 == 0) {
             FillAlpha(e, b, a);
         } else {
@@ -60,7 +71,7 @@ int RecursorBase<M, E, C>::FillAlphaBeta(const E& e, M& a, M& b) const
         flipflops++;
     }
 
-    if (std::fabs(a(I, J) - b(0, 0)) > ALPHA_BETA_MISMATCH_TOLERANCE) {
+    if (std::fabs(a(I, J) - b(0, 0)) > tolerance) {
         LDEBUG << "Could not mate alpha, beta.  Read: " << e.ReadName() << " Tpl: " << e.Template();
         throw AlphaBetaMismatchException();
     }
@@ -207,8 +218,9 @@ const PairwiseAlignment* RecursorBase<M, E, C>::Alignment(const E& e, const M& a
 }
 
 template <typename M, typename E, typename C>
-RecursorBase<M, E, C>::RecursorBase(int movesAvailable, const BandingOptions& bandingOptions)
-    : movesAvailable_(movesAvailable), bandingOptions_(bandingOptions)
+RecursorBase<M, E, C>::RecursorBase(int movesAvailable, const BandingOptions& bandingOptions,
+                                    const RecursorConfig& config)
+    : movesAvailable_(movesAvailable), bandingOptions_(bandingOptions), recursorConfig_(config)
 {
 }
 
@@ -222,5 +234,8 @@ template class RecursorBase<DenseMatrix, QvEvaluator, ViterbiCombiner>;
 template class RecursorBase<SparseMatrix, QvEvaluator, ViterbiCombiner>;
 template class RecursorBase<SparseMatrix, QvEvaluator, SumProductCombiner>;
 template class RecursorBase<SparseMatrix, EdnaEvaluator, SumProductCombiner>;
+template class RecursorBase<Int16Matrix, QvEvaluator, ViterbiCombiner>;
+template class RecursorBase<HalfSparseMatrix, QvEvaluator, ViterbiCombiner>;
+template class RecursorBase<HalfSparseMatrix, QvEvaluator, SumProductCombiner>;
 }
 }
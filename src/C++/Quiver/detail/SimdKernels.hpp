@@ -0,0 +1,291 @@
+#pragma once
+// This header is internal, not part of the API!  It holds the lane-width
+// generic fill loops behind SseRecursor.  SseRecursor.cpp instantiates them
+// for SSE; the SimdKernels*.cpp translation units include this header under a
+// wider target and instantiate them for AVX2/AVX-512.
+#ifdef SWIG
+#error "SimdKernels.hpp is not an API-facing header!"
+#endif  // SWIG
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+#include <vector>
+
+#include <ConsensusCore/Interval.hpp>
+#include <ConsensusCore/Quiver/QuiverConfig.hpp>
+#include <ConsensusCore/Quiver/detail/RecursorBase.hpp>
+#include <ConsensusCore/Quiver/detail/SimdLanes.hpp>
+
+#define NEG_INF -FLT_MAX
+
+namespace ConsensusCore {
+namespace detail {
+
+template <typename V, typename M, typename E, typename C>
+struct SimdKernels
+{
+    typedef typename V::Vec Vec;
+
+    static void FillAlpha(const RecursorBase<M, E, C>& recursor, int movesAvailable,
+                          float scoreDiff, const E& e, const M& guide,
+                          const std::vector<Interval>& bandSeed, M& alpha);
+
+    static void FillBeta(const RecursorBase<M, E, C>& recursor, int movesAvailable, float scoreDiff,
+                         const E& e, const M& guide, M& beta);
+};
+
+template <typename V, typename M, typename E, typename C>
+void SimdKernels<V, M, E, C>::FillAlpha(const RecursorBase<M, E, C>& recursor, int movesAvailable,
+                                        float scoreDiff, const E& e, const M& guide,
+                                        const std::vector<Interval>& bandSeed, M& alpha)
+{
+    const int W = V::Lanes;
+    int I = e.ReadLength();
+    int J = e.TemplateLength();
+
+    assert(alpha.Rows() == I + 1 && alpha.Columns() == J + 1);
+    assert(guide.IsNull() || (guide.Rows() == alpha.Rows() && guide.Columns() == alpha.Columns()));
+
+    int hintBeginRow = 0, hintEndRow = 0;
+
+    for (int j = 0; j <= J; ++j) {
+        recursor.RangeGuide(j, guide, alpha, bandSeed, &hintBeginRow, &hintEndRow);
+
+        int requiredEndRow = std::min(I + 1, hintEndRow);
+
+        float score = NEG_INF;
+        float thresholdScore = NEG_INF;
+        float maxScore = NEG_INF;
+
+        alpha.StartEditingColumn(j, hintBeginRow, hintEndRow);
+
+        int i;
+        int beginRow = hintBeginRow, endRow;
+        // Handle beginning rows non-SIMD.  Must handle row 0 this
+        // way (if row 0 is to be filled), and must terminate with
+        // (I - i + 1) divisible by W, so that the SIMD loop can
+        // run safely to the end.  Banding optimizations not applied
+        // here.
+        for (i = beginRow; (i == 0 || (I - i + 1) % W != 0) && i <= I; i++) {
+            score = NEG_INF;
+
+            // Start:
+            if (i == 0 && j == 0) {
+                score = 0.0f;
+            }
+            // Inc
+            if (i > 0 && j > 0) {
+                score = C::Combine(score, alpha(i - 1, j - 1) + e.Inc(i - 1, j - 1));
+            }
+            // Merge
+            if ((movesAvailable & MERGE) && (i > 0 && j > 1)) {
+                score = C::Combine(score, alpha(i - 1, j - 2) + e.Merge(i - 1, j - 2));
+            }
+            // Delete
+            if (j > 0) {
+                score = C::Combine(score, alpha(i, j - 1) + e.Del(i, j - 1));
+            }
+            // Extra
+            if (i > 0) {
+                score = C::Combine(score, alpha(i - 1, j) + e.Extra(i - 1, j));
+            }
+            alpha.Set(i, j, score);
+
+            if (score > maxScore) {
+                maxScore = score;
+                thresholdScore = maxScore - scoreDiff;
+            }
+        }
+        //
+        // Main SIMD loop
+        //
+        assert(i > 0);
+        for (; i <= I && (score >= thresholdScore || i < requiredEndRow); i += W) {
+            Vec scoreW = V::Fill(NEG_INF);
+            // Incorporation:
+            if (j > 0) {
+                scoreW = V::template Combine<C>(
+                    scoreW, V::Get(alpha, i - 1, j - 1) + V::Inc(e, i - 1, j - 1));
+            }
+            // Merge
+            if ((movesAvailable & MERGE) && j >= 2) {
+                scoreW = V::template Combine<C>(
+                    scoreW, V::Get(alpha, i - 1, j - 2) + V::Merge(e, i - 1, j - 2));
+            }
+            // Deletion:
+            if (j > 0) {
+                scoreW =
+                    V::template Combine<C>(scoreW, V::Get(alpha, i, j - 1) + V::Del(e, i, j - 1));
+            }
+
+            //
+            // Extra (prefix scan down the block)
+            //
+            scoreW = V::template PrefixScan<C>(scoreW, V::Extra(e, i - 1, j), alpha.Get(i - 1, j));
+            V::Set(alpha, i, j, scoreW);
+
+            // Update score, potentialNewMax, four rows at a time as the SSE
+            // kernel does, so that wider blocks band the column the same
+            // way.  Rows past the four that end the band are emptied again.
+            float scores_[W];
+            V::Store(scores_, scoreW);
+            int k = 0;
+            while (k < W) {
+                float potentialNewMax = *std::max_element(scores_ + k, scores_ + k + 4);
+                score = *std::min_element(scores_ + k, scores_ + k + 4);
+                if (potentialNewMax > maxScore) {
+                    maxScore = potentialNewMax;
+                    thresholdScore = maxScore - scoreDiff;
+                }
+                k += 4;
+                if (score < thresholdScore && i + k >= requiredEndRow) break;
+            }
+            if (k < W) {
+                for (int r = k; r < W; r += 4) {
+                    alpha.Set4(i + r, j, _mm_set_ps1(NEG_INF));
+                }
+                i += k;
+                break;
+            }
+        }
+
+        endRow = i;
+        alpha.FinishEditingColumn(j, beginRow, endRow);
+
+        // Now, revise the hints to tell the caller where the mass of the
+        // distribution really lived in this column.
+        hintEndRow = endRow;
+        for (i = beginRow; i < endRow && alpha(i, j) < thresholdScore; ++i)
+            ;
+        hintBeginRow = i;
+    }
+}
+
+template <typename V, typename M, typename E, typename C>
+void SimdKernels<V, M, E, C>::FillBeta(const RecursorBase<M, E, C>& recursor, int movesAvailable,
+                                       float scoreDiff, const E& e, const M& guide, M& beta)
+{
+    const int W = V::Lanes;
+    int I = e.ReadLength();
+    int J = e.TemplateLength();
+
+    assert(beta.Rows() == I + 1 && beta.Columns() == J + 1);
+    assert(guide.IsNull() || (guide.Rows() == beta.Rows() && guide.Columns() == beta.Columns()));
+
+    int hintBeginRow = I + 1, hintEndRow = I + 1;
+
+    for (int j = J; j >= 0; --j) {
+        recursor.RangeGuide(j, guide, beta, &hintBeginRow, &hintEndRow);
+
+        int requiredBeginRow = std::max(0, hintBeginRow);
+
+        float score = NEG_INF;
+        float thresholdScore = NEG_INF;
+        float maxScore = NEG_INF;
+
+        beta.StartEditingColumn(j, hintBeginRow, hintEndRow);
+        //
+        // See comment in FillAlpha---we are doing the same thing here.
+        // An initial non-SIMD loop, terminating when a multiple of W
+        // rows remain.
+        //
+        int i, beginRow, endRow = hintEndRow;
+        for (i = endRow - 1; (i == I || (i + 1) % W != 0) && i >= 0; i--) {
+            score = NEG_INF;
+
+            // Start:
+            if (i == I && j == J) {
+                score = 0.0f;
+            }
+            // Inc
+            if (i < I && j < J) {
+                score = C::Combine(score, beta(i + 1, j + 1) + e.Inc(i, j));
+            }
+            // Merge
+            if ((movesAvailable & MERGE) && j < J - 1 && i < I) {
+                score = C::Combine(score, beta(i + 1, j + 2) + e.Merge(i, j));
+            }
+            // Delete
+            if (j < J) {
+                score = C::Combine(score, beta(i, j + 1) + e.Del(i, j));
+            }
+            // Extra
+            if (i < I) {
+                score = C::Combine(score, beta(i + 1, j) + e.Extra(i, j));
+            }
+
+            beta.Set(i, j, score);
+
+            if (score > maxScore) {
+                maxScore = score;
+                thresholdScore = maxScore - scoreDiff;
+            }
+        }
+        //
+        // SIMD loop
+        //
+        // The band test looks at the first four rows of the next block, as
+        // the SSE kernel would, not at the start of the block
+        i = i - (W - 1);
+        for (; i >= 0 && (score >= thresholdScore || i + W - 4 >= requiredBeginRow); i -= W) {
+            Vec scoreW = V::Fill(NEG_INF);
+
+            // Incorporation:
+            if (i < I && j < J) {
+                scoreW =
+                    V::template Combine<C>(scoreW, V::Get(beta, i + 1, j + 1) + V::Inc(e, i, j));
+            }
+            // Merge
+            if ((movesAvailable & MERGE) && j < J - 1 && i < I) {
+                scoreW =
+                    V::template Combine<C>(scoreW, V::Get(beta, i + 1, j + 2) + V::Merge(e, i, j));
+            }
+            // Deletion:
+            if (j < J) {
+                scoreW = V::template Combine<C>(scoreW, V::Get(beta, i, j + 1) + V::Del(e, i, j));
+            }
+
+            //
+            // Extra (suffix scan up the block)
+            //
+            scoreW = V::template SuffixScan<C>(scoreW, V::Extra(e, i, j), beta.Get(i + W, j));
+            V::Set(beta, i, j, scoreW);
+
+            // Update score, potentialNewMax, four rows at a time from the
+            // bottom up; see FillAlpha
+            float scores_[W];
+            V::Store(scores_, scoreW);
+            int k = W;
+            while (k > 0) {
+                float potentialNewMax = *std::max_element(scores_ + k - 4, scores_ + k);
+                score = *std::min_element(scores_ + k - 4, scores_ + k);
+                if (potentialNewMax > maxScore) {
+                    maxScore = potentialNewMax;
+                    thresholdScore = maxScore - scoreDiff;
+                }
+                k -= 4;
+                if (score < thresholdScore && i + k - 4 < requiredBeginRow) break;
+            }
+            if (k > 0) {
+                for (int r = 0; r < k; r += 4) {
+                    beta.Set4(i + r, j, _mm_set_ps1(NEG_INF));
+                }
+                i += k - W;
+                break;
+            }
+        }
+
+        beginRow = i + W;
+        beta.FinishEditingColumn(j, beginRow, endRow);
+
+        // Now, revise the hints to tell the caller where the mass of the
+        // distribution really lived in this column.
+        hintBeginRow = beginRow;
+        for (i = endRow; i > beginRow && beta(i - 1, j) < thresholdScore; i--)
+            ;
+        hintEndRow = i;
+    }
+}
+}
+}
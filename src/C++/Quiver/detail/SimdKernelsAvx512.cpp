@@ -0,0 +1,45 @@
+// Instantiations of the recursor fill kernels for avx512f.  Everything the
+// kernels depend on is included before the target pragma, so that shared
+// inline code keeps the baseline target; only the kernel bodies below are
+// compiled for avx512f.
+
+#include <ConsensusCore/Matrix/DenseMatrix.hpp>
+#include <ConsensusCore/Matrix/SparseMatrix.hpp>
+#include <ConsensusCore/Quiver/QuiverConfig.hpp>
+#include <ConsensusCore/Quiver/QvEvaluator.hpp>
+#include <ConsensusCore/Quiver/detail/Combiner.hpp>
+#include <ConsensusCore/Quiver/detail/RecursorBase.hpp>
+#include <ConsensusCore/Quiver/detail/SimdLanes.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <cfloat>
+
+#ifdef CC_SIMD_DISPATCH
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx512f"))), apply_to = function)
+#else
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+#endif
+
+#include "SimdKernels.hpp"
+
+namespace ConsensusCore {
+namespace detail {
+
+// Only the types with native wide accessors; see HasWideAccessors
+template struct SimdKernels<Simd16, DenseMatrix, QvEvaluator, ViterbiCombiner>;
+template struct SimdKernels<Simd16, SparseMatrix, QvEvaluator, ViterbiCombiner>;
+template struct SimdKernels<Simd16, SparseMatrix, QvEvaluator, SumProductCombiner>;
+}
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#else
+#pragma GCC pop_options
+#endif
+
+#endif  // CC_SIMD_DISPATCH
@@ -2,10 +2,12 @@
 %{
 /* Includes the header in the wrapper code */
 #include <ConsensusCore/Quiver/QvEvaluator.hpp>
+#include <ConsensusCore/Quiver/InterleavedQvEvaluator.hpp>
 #include <ConsensusCore/Edna/EdnaEvaluator.hpp>
 using namespace ConsensusCore;
 %}
 
 
 %include <ConsensusCore/Quiver/QvEvaluator.hpp>
+%include <ConsensusCore/Quiver/InterleavedQvEvaluator.hpp>
 %include <ConsensusCore/Edna/EdnaEvaluator.hpp>
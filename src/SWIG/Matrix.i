@@ -2,7 +2,10 @@
 /* Includes the header in the wrapper code */
 #include <ConsensusCore/Types.hpp>
 #include <ConsensusCore/Matrix/AbstractMatrix.hpp>
+#include <ConsensusCore/Matrix/CompactSparseMatrix.hpp>
 #include <ConsensusCore/Matrix/DenseMatrix.hpp>
+#include <ConsensusCore/Matrix/Int16Matrix.hpp>
+#include <ConsensusCore/Matrix/InterleavedMatrix.hpp>
 #include <ConsensusCore/Matrix/SparseMatrix.hpp>
 using namespace ConsensusCore;
 %}
@@ -20,4 +23,12 @@ using namespace ConsensusCore;
 
 %include <ConsensusCore/Matrix/AbstractMatrix.hpp>
 %include <ConsensusCore/Matrix/DenseMatrix.hpp>
+%include <ConsensusCore/Matrix/Int16Matrix.hpp>
+%include <ConsensusCore/Matrix/InterleavedMatrix.hpp>
 %include <ConsensusCore/Matrix/SparseMatrix.hpp>
+%include <ConsensusCore/Matrix/HalfFloat.hpp>
+%include <ConsensusCore/Matrix/CompactSparseMatrix.hpp>
+
+namespace ConsensusCore {
+    %template(HalfSparseMatrix)       CompactSparseMatrix<HalfFormat>;
+}
@@ -3,10 +3,14 @@
 #include <ConsensusCore/Sequence.hpp>
 #include <ConsensusCore/Mutation.hpp>
 #include <ConsensusCore/Read.hpp>
+#include <ConsensusCore/Quiver/BatchMutationScorer.hpp>
+#include <ConsensusCore/Quiver/BatchRecursor.hpp>
+#include <ConsensusCore/Quiver/Int16Recursor.hpp>
 #include <ConsensusCore/Quiver/MultiReadMutationScorer.hpp>
 #include <ConsensusCore/Quiver/MutationScorer.hpp>
 #include <ConsensusCore/Quiver/QuiverConfig.hpp>
 #include <ConsensusCore/Quiver/SimpleRecursor.hpp>
+#include <ConsensusCore/Quiver/SimdLevel.hpp>
 #include <ConsensusCore/Quiver/SseRecursor.hpp>
 #include <ConsensusCore/Quiver/ReadScorer.hpp>
 #include <ConsensusCore/Quiver/Diploid.hpp>
@@ -39,11 +43,22 @@ using namespace ConsensusCore;
 %include <ConsensusCore/Read.hpp>
 %include <ConsensusCore/Quiver/detail/Combiner.hpp>
 %include <ConsensusCore/Quiver/detail/RecursorBase.hpp>
+%include <ConsensusCore/Quiver/BatchRecursor.hpp>
+%include <ConsensusCore/Quiver/BatchMutationScorer.hpp>
 %include <ConsensusCore/Quiver/MultiReadMutationScorer.hpp>
 %include <ConsensusCore/Quiver/MutationScorer.hpp>
 %include <ConsensusCore/Quiver/QuiverConfig.hpp>
+%include <ConsensusCore/Quiver/SimdLevel.hpp>
 %include <ConsensusCore/Quiver/SimpleRecursor.hpp>
 %include <ConsensusCore/Quiver/SseRecursor.hpp>
+
+namespace ConsensusCore {
+    // Bases of Int16QvRecursor, which SWIG must know before the class itself
+    %template(Int16QvRecursorBase)    detail::RecursorBase<Int16Matrix, QvEvaluator, detail::ViterbiCombiner>;
+    %template(Int16SseQvRecursor)     SseRecursor<Int16Matrix, QvEvaluator, detail::ViterbiCombiner>;
+}
+
+%include <ConsensusCore/Quiver/Int16Recursor.hpp>
 %include <ConsensusCore/Quiver/ReadScorer.hpp>
 %include <ConsensusCore/Quiver/Diploid.hpp>
 %include <ConsensusCore/Quiver/QuiverConsensus.hpp>
@@ -81,6 +96,32 @@ namespace ConsensusCore {
 
     %template(SparseSseQvSumProductMultiReadMutationScorer) MultiReadMutationScorer<SparseSseQvSumProductRecursor>;
 
+    //
+    // Fixed-point (int16) Viterbi support
+    //
+    %template(Int16QvMutationScorer)              MutationScorer<Int16QvRecursor>;
+    %template(Int16QvMultiReadMutationScorer)     MultiReadMutationScorer<Int16QvRecursor>;
+
+    //
+    // 16-bit float (half) matrix support
+    //
+    %template(HalfQvRecursorBase)                       detail::RecursorBase<HalfSparseMatrix, QvEvaluator, detail::ViterbiCombiner>;
+    %template(HalfSseQvRecursor)                        SseRecursor<HalfSparseMatrix, QvEvaluator, detail::ViterbiCombiner>;
+    %template(HalfSseQvMutationScorer)                  MutationScorer<HalfSseQvRecursor>;
+    %template(HalfSseQvMultiReadMutationScorer)         MultiReadMutationScorer<HalfSseQvRecursor>;
+    %template(HalfQvSumProductRecursorBase)             detail::RecursorBase<HalfSparseMatrix, QvEvaluator, detail::SumProductCombiner>;
+    %template(HalfSseQvSumProductRecursor)              SseRecursor<HalfSparseMatrix, QvEvaluator, detail::SumProductCombiner>;
+    %template(HalfSseQvSumProductMutationScorer)        MutationScorer<HalfSseQvSumProductRecursor>;
+    %template(HalfSseQvSumProductMultiReadMutationScorer) MultiReadMutationScorer<HalfSseQvSumProductRecursor>;
+
+    //
+    // Batched (one read per SSE lane) support
+    //
+    %template(BatchQvRecursor)                   BatchRecursor<InterleavedQvEvaluator, detail::ViterbiCombiner>;
+    %template(BatchQvMutationScorer)             BatchMutationScorer<BatchQvRecursor>;
+    %template(BatchQvSumProductRecursor)         BatchRecursor<InterleavedQvEvaluator, detail::SumProductCombiner>;
+    %template(BatchQvSumProductMutationScorer)   BatchMutationScorer<BatchQvSumProductRecursor>;
+
     //
     // Edna evaluator support
     //
@@ -101,6 +101,38 @@ QvEvaluator RandomQvEvaluator(RNG& rng, int length)
     return QvEvaluator(read, tpl, TestingParams(), pinStart, pinEnd);
 }
 
+// A read drawn from the template with a few random edits, so that the
+// evaluator scores like a real one rather than like noise
+template <typename RNG>
+QvEvaluator RandomNoisyQvEvaluator(RNG& rng, int tplLength)
+{
+    std::string tpl = RandomSequence(rng, tplLength);
+    std::string seq;
+    for (int j = 0; j < tplLength; j++) {
+        if (RandomBernoulliDraw(rng, 0.05f)) continue;
+        if (RandomBernoulliDraw(rng, 0.05f)) seq += RandomSequence(rng, 1);
+        seq += RandomBernoulliDraw(rng, 0.05f) ? RandomSequence(rng, 1)[0] : tpl[j];
+    }
+    int readLength = seq.length();
+
+    float* insQv = RandomQvArray(rng, readLength);
+    float* subsQv = RandomQvArray(rng, readLength);
+    float* delQv = RandomQvArray(rng, readLength);
+    float* delTag = RandomTagArray(rng, readLength);
+    float* mergeQv = RandomQvArray(rng, readLength);
+
+    QvSequenceFeatures f(seq, insQv, subsQv, delQv, delTag, mergeQv);
+    Read read(f, "noisy", "unknown");
+
+    delete[] insQv;
+    delete[] subsQv;
+    delete[] delQv;
+    delete[] delTag;
+    delete[] mergeQv;
+
+    return QvEvaluator(read, tpl, TestingParams(), true, true);
+}
+
 template <typename RNG>
 std::vector<int> RandomSampleWithoutReplacement(RNG& rng, int n, int k)
 {
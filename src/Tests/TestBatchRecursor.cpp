@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include <ConsensusCore/Matrix/DenseMatrix.hpp>
+#include <ConsensusCore/Matrix/InterleavedMatrix.hpp>
+#include <ConsensusCore/Matrix/SparseMatrix.hpp>
+#include <ConsensusCore/Mutation.hpp>
+#include <ConsensusCore/Quiver/BatchMutationScorer.hpp>
+#include <ConsensusCore/Quiver/BatchRecursor.hpp>
+#include <ConsensusCore/Quiver/InterleavedQvEvaluator.hpp>
+#include <ConsensusCore/Quiver/MutationScorer.hpp>
+#include <ConsensusCore/Quiver/QvEvaluator.hpp>
+#include <ConsensusCore/Quiver/SimpleRecursor.hpp>
+#include <ConsensusCore/Quiver/SseRecursor.hpp>
+
+#include "ParameterSettings.hpp"
+#include "Random.hpp"
+
+using namespace ConsensusCore;  // NOLINT
+
+namespace {
+
+// Reads of assorted lengths, all against one template
+std::vector<QvEvaluator> SharedTemplateEvaluators(int numReads, int tplLen, int seed)
+{
+    Rng rng(seed);
+    std::string tpl = RandomSequence(rng, tplLen);
+    std::vector<QvEvaluator> evaluators;
+    for (int n = 0; n < numReads; n++) {
+        QvEvaluator e = RandomQvEvaluator(rng, tplLen);
+        e.Template(tpl);
+        evaluators.push_back(e);
+    }
+    return evaluators;
+}
+
+std::vector<Mutation> AllSingleBaseMutations(const std::string& tpl)
+{
+    std::vector<Mutation> mutations;
+    for (int pos = 0; pos < static_cast<int>(tpl.length()); pos++) {
+        mutations.push_back(Mutation(DELETION, pos, '-'));
+        foreach (char base, std::string("ACGT")) {
+            mutations.push_back(Mutation(INSERTION, pos, base));
+            if (base != tpl[pos]) {
+                mutations.push_back(Mutation(SUBSTITUTION, pos, base));
+            }
+        }
+    }
+    return mutations;
+}
+
+void ExpectClose(float expected, float actual, float relTol)
+{
+    EXPECT_NEAR(expected, actual, relTol * std::max(1.0f, std::fabs(expected)));
+}
+}
+
+// A band wider than any score makes both recursors exact, so lane k of the batch must
+// reproduce the single-read score of read k.
+TEST(BatchRecursorTest, MatchesSingleReadRecursor)
+{
+    BandingOptions banding(4, 1000);
+    BatchQvRecursor batchRecursor(ALL_MOVES, banding);
+    SimpleQvRecursor simpleRecursor(ALL_MOVES, banding);
+
+    for (int seed = 0; seed < 20; seed++) {
+        // One to four reads, so most batches are partially filled
+        int numReads = 1 + seed % 4;
+        std::vector<QvEvaluator> es = SharedTemplateEvaluators(numReads, 25, seed);
+        InterleavedQvEvaluator batch(es);
+        int I = batch.MaxReadLength();
+        int J = batch.MaxTemplateLength();
+
+        InterleavedMatrix alpha(I + 1, J + 1), beta(I + 1, J + 1);
+        std::vector<float> scores = batchRecursor.FillAlphaBeta(batch, alpha, beta);
+        ASSERT_EQ(es.size(), scores.size());
+
+        for (size_t k = 0; k < es.size(); k++) {
+            int Ik = es[k].ReadLength();
+            DenseMatrix a(Ik + 1, J + 1), b(Ik + 1, J + 1);
+            simpleRecursor.FillAlpha(es[k], DenseMatrix::Null(), a);
+            simpleRecursor.FillBeta(es[k], DenseMatrix::Null(), b);
+            EXPECT_FLOAT_EQ(a(Ik, J), alpha.Get(Ik, J, k));
+            EXPECT_FLOAT_EQ(b(0, 0), scores[k]);
+        }
+    }
+}
+
+// Reads against windows of different lengths share a batch.  The batch band
+// is the union of the lanes' bands, so at a narrow ScoreDiff each lane must
+// score as well as the same read filled on its own with the same banding.
+template <typename B, typename S>
+void CheckDifferingWindows(const BandingOptions& banding, float relTol)
+{
+    B batchRecursor(ALL_MOVES, banding);
+    S singleRecursor(ALL_MOVES, banding);
+
+    Rng rng(11);
+    for (int trial = 0; trial < 5; trial++) {
+        std::vector<QvEvaluator> es;
+        for (int k = 0; k < 1 + trial % 4; k++) {
+            es.push_back(RandomNoisyQvEvaluator(rng, 300 - 60 * k + 7 * trial));
+        }
+        InterleavedQvEvaluator batch(es);
+        int I = batch.MaxReadLength();
+        int J = batch.MaxTemplateLength();
+
+        InterleavedMatrix alpha(I + 1, J + 1), beta(I + 1, J + 1);
+        std::vector<float> scores = batchRecursor.FillAlphaBeta(batch, alpha, beta);
+        ASSERT_EQ(es.size(), scores.size());
+
+        for (size_t k = 0; k < es.size(); k++) {
+            int Ik = es[k].ReadLength(), Jk = es[k].TemplateLength();
+            SparseMatrix a(Ik + 1, Jk + 1), b(Ik + 1, Jk + 1);
+            SCOPED_TRACE(testing::Message() << "trial " << trial << " lane " << k);
+            singleRecursor.FillAlphaBeta(es[k], a, b);
+            float single = b(0, 0);
+            ExpectClose(single, scores[k], relTol);
+            ExpectClose(single, alpha.Get(Ik, Jk, k), relTol);
+        }
+    }
+}
+
+TEST(BatchRecursorTest, ViterbiBandedDifferingWindows)
+{
+    CheckDifferingWindows<BatchQvRecursor, SparseSseQvRecursor>(BandingOptions(4, 25), 1e-4);
+    CheckDifferingWindows<BatchQvRecursor, SparseSseQvRecursor>(BandingOptions(4, 50), 1e-4);
+}
+
+TEST(BatchRecursorTest, SumProductBandedDifferingWindows)
+{
+    CheckDifferingWindows<BatchQvSumProductRecursor, SparseSseQvSumProductRecursor>(
+        BandingOptions(4, 25), 1e-3);
+    CheckDifferingWindows<BatchQvSumProductRecursor, SparseSseQvSumProductRecursor>(
+        BandingOptions(4, 50), 1e-3);
+}
+
+template <typename B, typename S>
+void CheckMutationScores(float relTol)
+{
+    BandingOptions banding(4, 1000);
+    typename B::RecursorType batchRecursor(ALL_MOVES, banding);
+    typename S::RecursorType simpleRecursor(ALL_MOVES, banding);
+
+    for (int seed = 0; seed < 4; seed++) {
+        std::vector<QvEvaluator> es = SharedTemplateEvaluators(6, 20, 100 + seed);
+        B batch(es, batchRecursor);
+        ASSERT_EQ(6, batch.NumReads());
+
+        std::vector<S*> singles;
+        foreach (const QvEvaluator& e, es) {
+            singles.push_back(new S(e, simpleRecursor));
+        }
+
+        std::vector<float> baseline = batch.Scores();
+        for (size_t k = 0; k < es.size(); k++) {
+            ExpectClose(singles[k]->Score(), baseline[k], relTol);
+        }
+
+        // Away from the template start the batch extends and links just as
+        // MutationScorer does; near it, it refills alpha, which is exact.
+        foreach (const Mutation& m, AllSingleBaseMutations(batch.Template())) {
+            SCOPED_TRACE(m.ToString());
+            std::vector<float> scores = batch.ScoreMutation(m);
+            ASSERT_EQ(es.size(), scores.size());
+            std::string newTpl = ApplyMutation(m, batch.Template());
+            for (size_t k = 0; k < es.size(); k++) {
+                if (m.Start() >= 3) {
+                    ExpectClose(singles[k]->ScoreMutation(m), scores[k], relTol);
+                } else {
+                    QvEvaluator e = es[k];
+                    e.Template(newTpl);
+                    typename S::MatrixType alpha(e.ReadLength() + 1, newTpl.length() + 1);
+                    simpleRecursor.FillAlpha(e, S::MatrixType::Null(), alpha);
+                    ExpectClose(alpha(e.ReadLength(), newTpl.length()), scores[k], relTol);
+                }
+            }
+        }
+        EXPECT_EQ(es[0].Template(), batch.Template());
+
+        foreach (S* s, singles) {
+            delete s;
+        }
+    }
+}
+
+TEST(BatchMutationScorerTest, ViterbiMatchesMutationScorer)
+{
+    CheckMutationScores<BatchQvMutationScorer, MutationScorer<SimpleQvRecursor> >(1e-5);
+}
+
+TEST(BatchMutationScorerTest, SumProductMatchesMutationScorer)
+{
+    CheckMutationScores<BatchQvSumProductMutationScorer,
+                        MutationScorer<SparseSimpleQvSumProductRecursor> >(1e-4);
+}
+
+TEST(BatchMutationScorerTest, TemplateMustBeShared)
+{
+    std::vector<QvEvaluator> es = SharedTemplateEvaluators(3, 20, 7);
+    es[2].Template("ACGTACGTACGTACGTACGT");
+    BatchQvRecursor recursor(ALL_MOVES, BandingOptions(4, 200));
+    EXPECT_THROW(BatchQvMutationScorer(es, recursor), InvalidInputError);
+}
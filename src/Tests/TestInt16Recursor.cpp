@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <ConsensusCore/Matrix/Int16Matrix.hpp>
+#include <ConsensusCore/Matrix/SparseMatrix.hpp>
+#include <ConsensusCore/Mutation.hpp>
+#include <ConsensusCore/Quiver/Int16Recursor.hpp>
+#include <ConsensusCore/Quiver/MutationScorer.hpp>
+#include <ConsensusCore/Quiver/QvEvaluator.hpp>
+#include <ConsensusCore/Quiver/SseRecursor.hpp>
+
+#include "ParameterSettings.hpp"
+#include "Random.hpp"
+
+using namespace ConsensusCore;  // NOLINT
+
+namespace {
+
+// Half a quantum of error per move, over the at most I + J moves of a path
+float QuantizationTolerance(const QvEvaluator& e, const BandingOptions& banding)
+{
+    return 0.5f * (e.ReadLength() + e.TemplateLength()) / Int16Matrix::ScaleFor(banding.ScoreDiff);
+}
+}
+
+TEST(Int16MatrixTest, QuantizedColumnRoundTrip)
+{
+    Int16Matrix m(10, 3);
+    const int16_t values[] = {-256, Int16Matrix::EMPTY_CELL, 0, -64};
+    m.SetQuantizedColumn(1, Int16Matrix::SCALE, -1280, 3, 7, values);
+
+    EXPECT_TRUE(m.IsQuantized(1));
+    EXPECT_FALSE(m.IsQuantized(0));
+    EXPECT_EQ(Int16Matrix::SCALE, m.Scale(1));
+    EXPECT_EQ(Interval(3, 7), m.UsedRowRange(1));
+    EXPECT_EQ(-1280, m.Base(1));
+    EXPECT_EQ(-256, m.GetQuantized(3, 1));
+    EXPECT_EQ(Int16Matrix::EMPTY_CELL, m.GetQuantized(2, 1));
+    EXPECT_FLOAT_EQ(-12.0f, m(3, 1));
+    EXPECT_EQ(-FLT_MAX, m(4, 1));
+    EXPECT_FLOAT_EQ(-10.0f, m(5, 1));
+    EXPECT_FLOAT_EQ(-10.5f, m(6, 1));
+    EXPECT_EQ(-FLT_MAX, m(7, 1));
+    EXPECT_EQ(4, m.UsedEntries());
+
+    // Float columns still work alongside quantized ones
+    m.StartEditingColumn(2, 0, 10);
+    m.Set(4, 2, -3.25f);
+    m.FinishEditingColumn(2, 4, 5);
+    EXPECT_FALSE(m.IsQuantized(2));
+    EXPECT_FLOAT_EQ(-3.25f, m(4, 2));
+    EXPECT_FLOAT_EQ(-12.0f, m(3, 1));
+
+    // Coarser columns read back in their own units
+    m.SetQuantizedColumn(0, 32, -64, 0, 2, values);
+    EXPECT_EQ(32, m.Scale(0));
+    EXPECT_FLOAT_EQ(-10.0f, m(0, 0));
+    EXPECT_FLOAT_EQ(-12.0f, m(3, 1));
+}
+
+TEST(Int16MatrixTest, ScaleForBand)
+{
+    EXPECT_EQ(Int16Matrix::SCALE, Int16Matrix::ScaleFor(25));
+    EXPECT_EQ(Int16Matrix::SCALE, Int16Matrix::ScaleFor(100));
+    EXPECT_EQ(64, Int16Matrix::ScaleFor(200));
+    EXPECT_EQ(Int16Matrix::MIN_SCALE, Int16Matrix::ScaleFor(400));
+    EXPECT_EQ(0, Int16Matrix::ScaleFor(1000));
+}
+
+// Within a band the int16 range can hold, alpha and beta are quantized and
+// agree with the float recursor's up to rounding of the move scores.
+TEST(Int16RecursorTest, MatchesFloatRecursor)
+{
+    BandingOptions banding(4, 100);
+    Int16QvRecursor int16Recursor(ALL_MOVES, banding);
+    SparseSseQvRecursor floatRecursor(ALL_MOVES, banding);
+
+    Rng rng(42);
+    for (int n = 0; n < 20; n++) {
+        QvEvaluator e = RandomNoisyQvEvaluator(rng, 30 + n * 5);
+        int I = e.ReadLength(), J = e.TemplateLength();
+
+        Int16Matrix alpha(I + 1, J + 1), beta(I + 1, J + 1);
+        SparseMatrix floatAlpha(I + 1, J + 1), floatBeta(I + 1, J + 1);
+        int16Recursor.FillAlphaBeta(e, alpha, beta);
+        floatRecursor.FillAlphaBeta(e, floatAlpha, floatBeta);
+
+        for (int j = 0; j <= J; j++) {
+            EXPECT_TRUE(alpha.IsQuantized(j));
+            EXPECT_TRUE(beta.IsQuantized(j));
+        }
+        float tol = QuantizationTolerance(e, banding);
+        EXPECT_NEAR(floatAlpha(I, J), alpha(I, J), tol);
+        EXPECT_NEAR(floatBeta(0, 0), beta(0, 0), tol);
+        EXPECT_NEAR(alpha(I, J), beta(0, 0), tol);
+    }
+}
+
+TEST(Int16RecursorTest, MutationScoresMatchFloatRecursor)
+{
+    BandingOptions banding(4, 100);
+    Int16QvRecursor int16Recursor(ALL_MOVES, banding);
+    SparseSseQvRecursor floatRecursor(ALL_MOVES, banding);
+
+    Rng rng(7);
+    for (int n = 0; n < 4; n++) {
+        QvEvaluator e = RandomNoisyQvEvaluator(rng, 40);
+        Int16QvMutationScorer int16Scorer(e, int16Recursor);
+        SparseSseQvMutationScorer floatScorer(e, floatRecursor);
+
+        // Linking and extension run in float over the quantized columns, so
+        // mutated scores carry the same rounding error as the baseline
+        float tol = 2 * QuantizationTolerance(e, banding);
+        EXPECT_NEAR(floatScorer.Score(), int16Scorer.Score(), tol);
+        const std::string tpl = e.Template();
+        for (int pos = 0; pos < static_cast<int>(tpl.length()); pos++) {
+            std::vector<Mutation> mutations;
+            mutations.push_back(Mutation(DELETION, pos, '-'));
+            mutations.push_back(Mutation(INSERTION, pos, 'A'));
+            mutations.push_back(Mutation(SUBSTITUTION, pos, tpl[pos] == 'C' ? 'G' : 'C'));
+            foreach (const Mutation& m, mutations) {
+                SCOPED_TRACE(m.ToString());
+                EXPECT_NEAR(floatScorer.ScoreMutation(m), int16Scorer.ScoreMutation(m), tol);
+            }
+        }
+    }
+}
+
+// Wider bands are quantized at a coarser scale rather than given up on.
+TEST(Int16RecursorTest, QuantizesWideBandsAtCoarserScale)
+{
+    BandingOptions banding(4, 200);
+    Int16QvRecursor int16Recursor(ALL_MOVES, banding);
+    SparseSseQvRecursor floatRecursor(ALL_MOVES, banding);
+
+    Rng rng(3);
+    for (int n = 0; n < 5; n++) {
+        QvEvaluator e = RandomNoisyQvEvaluator(rng, 50 + 100 * n);
+        int I = e.ReadLength(), J = e.TemplateLength();
+
+        Int16Matrix alpha(I + 1, J + 1), beta(I + 1, J + 1);
+        SparseMatrix floatAlpha(I + 1, J + 1), floatBeta(I + 1, J + 1);
+        int16Recursor.FillAlphaBeta(e, alpha, beta);
+        floatRecursor.FillAlphaBeta(e, floatAlpha, floatBeta);
+
+        for (int j = 0; j <= J; j++) {
+            ASSERT_TRUE(alpha.IsQuantized(j));
+            ASSERT_TRUE(beta.IsQuantized(j));
+            EXPECT_EQ(64, alpha.Scale(j));
+        }
+        float tol = QuantizationTolerance(e, banding);
+        EXPECT_NEAR(floatAlpha(I, J), alpha(I, J), tol);
+        EXPECT_NEAR(floatBeta(0, 0), beta(0, 0), tol);
+    }
+}
+
+// A ScoreDiff too wide for the int16 range at any scale sends the fill to
+// the float kernels, whose results are then exact.
+TEST(Int16RecursorTest, FallsBackToFloatForWideBands)
+{
+    BandingOptions banding(4, 1000);
+    Int16QvRecursor int16Recursor(ALL_MOVES, banding);
+    SparseSseQvRecursor floatRecursor(ALL_MOVES, banding);
+
+    Rng rng(3);
+    QvEvaluator e = RandomNoisyQvEvaluator(rng, 50);
+    int I = e.ReadLength(), J = e.TemplateLength();
+
+    Int16Matrix alpha(I + 1, J + 1), beta(I + 1, J + 1);
+    SparseMatrix floatAlpha(I + 1, J + 1), floatBeta(I + 1, J + 1);
+    int16Recursor.FillAlphaBeta(e, alpha, beta);
+    floatRecursor.FillAlphaBeta(e, floatAlpha, floatBeta);
+
+    for (int j = 0; j <= J; j++) {
+        EXPECT_FALSE(alpha.IsQuantized(j));
+        EXPECT_FALSE(beta.IsQuantized(j));
+    }
+    EXPECT_FLOAT_EQ(floatAlpha(I, J), alpha(I, J));
+    EXPECT_FLOAT_EQ(floatBeta(0, 0), beta(0, 0));
+}
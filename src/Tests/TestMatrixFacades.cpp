@@ -11,6 +11,7 @@
 #include <vector>
 
 #include <ConsensusCore/LFloat.hpp>
+#include <ConsensusCore/Matrix/CompactSparseMatrix.hpp>
 #include <ConsensusCore/Matrix/DenseMatrix.hpp>
 #include <ConsensusCore/Matrix/SparseMatrix.hpp>
 
@@ -18,6 +19,7 @@ using std::cout;
 using std::endl;
 
 using ConsensusCore::DenseMatrix;
+using ConsensusCore::HalfSparseMatrix;
 using ConsensusCore::SparseMatrix;
 using ConsensusCore::lfloat;
 
@@ -30,7 +32,7 @@ public:
 
 using testing::Types;
 // typedef Types<DenseMatrix> Implementations;
-typedef Types<DenseMatrix, SparseMatrix> Implementations;
+typedef Types<DenseMatrix, SparseMatrix, HalfSparseMatrix> Implementations;
 TYPED_TEST_CASE(MatrixTest, Implementations);
 
 TYPED_TEST(MatrixTest, Basic)
@@ -213,3 +215,116 @@ TYPED_TEST(MatrixTest, CopyTest)
 
     ASSERT_EQ(5, mCopy(1, 1));
 }
+
+// The 16-bit matrices store each block of four rows relative to its
+// maximum, which is kept exact; other entries carry the format's relative
+// rounding error on their distance below it.
+template <typename M>
+void CheckCompactPrecision(float relativeError)
+{
+    const float values[] = {-1234.5f, -1240.25f, -1300.0f, -FLT_MAX, -1234.75f, -1500.125f};
+    const float blockMax[] = {-1234.5f, -1234.5f, -1234.75f, -1234.75f, -1234.75f, -1234.75f};
+    M m(8, 2);
+    m.StartEditingColumn(1, 0, 8);
+    for (int i = 0; i < 6; i++) {
+        m.Set(i + 2, 1, values[i]);
+    }
+    m.FinishEditingColumn(1, 2, 8);
+
+    EXPECT_EQ(-1234.5f, m(2, 1));
+    EXPECT_EQ(-1234.75f, m(6, 1));
+    EXPECT_EQ(-FLT_MAX, m(5, 1));
+    EXPECT_EQ(-FLT_MAX, m(1, 1));
+    for (int i = 0; i < 6; i++) {
+        if (values[i] == -FLT_MAX) continue;
+        EXPECT_NEAR(values[i], m(i + 2, 1), relativeError * (blockMax[i] - values[i]));
+    }
+
+    // Get4 decodes the same values, and pads outside the used range
+    float read[4];
+    _mm_storeu_ps(read, m.Get4(5, 1));
+    EXPECT_EQ(-FLT_MAX, read[0]);
+    EXPECT_EQ(m(6, 1), read[1]);
+    EXPECT_EQ(m(7, 1), read[2]);
+    EXPECT_EQ(-FLT_MAX, read[3]);
+    // ... whether the four rows straddle two blocks or fill one
+    for (int begin = 2; begin <= 4; begin++) {
+        _mm_storeu_ps(read, m.Get4(begin, 1));
+        for (int i = 0; i < 4; i++) {
+            EXPECT_EQ(m(begin + i, 1), read[i]);
+        }
+    }
+}
+
+TEST(CompactSparseMatrixTest, HalfPrecision)
+{
+    CheckCompactPrecision<HalfSparseMatrix>(1.0f / 2048);
+}
+
+// Columns that outgrow their slab slots move, and the slab grows and
+// compacts under them; every value written must survive, in copies too.
+TEST(SparseMatrixTest, SlabGrowthKeepsColumns)
+{
+    const int rows = 300, cols = 50;
+    SparseMatrix m(rows, cols);
+    for (int j = 0; j < cols; j++) {
+        // Hint a narrow band, then write well outside it on both sides
+        int center = (j * 5) % (rows - 40) + 20;
+        m.StartEditingColumn(j, center, center + 2);
+        for (int i = center - 20; i < center + 20; i++) {
+            m.Set(i, j, -(i + 1000.0f * j));
+        }
+        m.FinishEditingColumn(j, center - 20, center + 20);
+        // Refill an earlier column with a wider band, moving it to the end
+        if (j % 7 == 6) {
+            int k = j - 3;
+            m.StartEditingColumn(k, 0, rows);
+            for (int i = 0; i < rows; i++) {
+                m.Set(i, k, -(i + 1000.0f * k));
+            }
+            m.FinishEditingColumn(k, 0, rows);
+        }
+    }
+
+    SparseMatrix copy(m);
+    for (int j = 0; j < cols; j++) {
+        int begin, end;
+        boost::tie(begin, end) = m.UsedRowRange(j);
+        for (int i = begin; i < end; i++) {
+            ASSERT_EQ(-(i + 1000.0f * j), m(i, j));
+            ASSERT_EQ(-(i + 1000.0f * j), copy(i, j));
+        }
+        if (begin >= 10) {
+            EXPECT_EQ(-FLT_MAX, m(begin - 10, j));
+        }
+    }
+    EXPECT_EQ(m.UsedEntries(), copy.UsedEntries());
+}
+
+// Refilling with narrow bands gives back the space of wide ones, so that
+// allocation tracks the bands in use rather than the widest ever filled.
+TEST(SparseMatrixTest, NarrowRefillsShrinkColumns)
+{
+    const int rows = 1000, cols = 100;
+    SparseMatrix m(rows, cols);
+    for (int j = 0; j < cols; j++) {
+        m.StartEditingColumn(j, 0, rows);
+        m.FinishEditingColumn(j, 0, rows);
+    }
+    EXPECT_EQ(rows * cols, m.AllocatedEntries());
+
+    for (int pass = 0; pass < 3; pass++) {
+        for (int j = 0; j < cols; j++) {
+            m.StartEditingColumn(j, 5 * j, 5 * j + 10);
+            for (int i = 5 * j; i < 5 * j + 10; i++) {
+                m.Set(i, j, -i);
+            }
+            m.FinishEditingColumn(j, 5 * j, 5 * j + 10);
+        }
+    }
+    // Each band is ten rows plus padding on either side
+    EXPECT_GE(30 * cols, m.AllocatedEntries());
+    for (int j = 0; j < cols; j++) {
+        EXPECT_EQ(-5 * j, m(5 * j, j));
+    }
+}
@@ -1,7 +1,9 @@
 // Author: David Alexander
 
 #include <gtest/gtest.h>
+#include <algorithm>
 #include <boost/assign.hpp>
+#include <cmath>
 #include <string>
 #include <vector>
 
@@ -13,6 +15,7 @@
 #include <ConsensusCore/Sequence.hpp>
 
 #include "ParameterSettings.hpp"
+#include "Random.hpp"
 
 using namespace ConsensusCore;  // NOLINT
 using namespace boost::assign;  // NOLINT
@@ -507,3 +510,82 @@ TYPED_TEST(MultiReadMutationScorerTest, MultiBaseIndelsAtBounds)
     EXPECT_EQ(params.Nce, mScorer.Score(Mutation(DELETION, 19, 21, "")));
     EXPECT_EQ(0, mScorer.Score(Mutation(DELETION, 20, 22, "")));
 }
+
+TYPED_TEST(MultiReadMutationScorerTest, AddReadsMatchesAddRead)
+{
+    // Noisy reads over windows of different lengths on both strands, more
+    // than fill one batch
+    Rng rng(5);
+    std::string tpl = RandomSequence(rng, 400);
+    std::vector<MappedRead> reads;
+    for (int n = 0; n < 7; n++) {
+        int tStart = 37 * n;
+        int tEnd = std::min(400, tStart + 120 + 23 * n);
+        std::string window = tpl.substr(tStart, tEnd - tStart);
+        std::string seq;
+        foreach (char base, window) {
+            if (RandomBernoulliDraw(rng, 0.05f)) continue;
+            if (RandomBernoulliDraw(rng, 0.05f)) seq += RandomSequence(rng, 1);
+            seq += base;
+        }
+        StrandEnum strand = (n % 2 == 0) ? FORWARD_STRAND : REVERSE_STRAND;
+        if (strand == REVERSE_STRAND) seq = ReverseComplement(seq);
+        reads.push_back(AnonymousMappedRead(seq, strand, tStart, tEnd));
+    }
+
+    MMS oneByOne(this->testingConfigs_, tpl);
+    std::vector<bool> expected;
+    foreach (const MappedRead& mr, reads) {
+        expected.push_back(oneByOne.AddRead(mr, 1.0f));
+    }
+    MMS batched(this->testingConfigs_, tpl);
+    EXPECT_EQ(expected, batched.AddReads(reads, 1.0f));
+
+    std::vector<float> expectedScores = oneByOne.BaselineScores();
+    std::vector<float> scores = batched.BaselineScores();
+    ASSERT_EQ(expectedScores.size(), scores.size());
+    for (size_t k = 0; k < scores.size(); k++) {
+        EXPECT_NEAR(expectedScores[k], scores[k], 1e-3f * std::fabs(expectedScores[k]));
+    }
+
+    for (int pos = 5; pos < 395; pos += 11) {
+        Mutation m(SUBSTITUTION, pos, tpl[pos] == 'A' ? 'C' : 'A');
+        EXPECT_NEAR(oneByOne.Score(m), batched.Score(m), 0.1f);
+    }
+}
+
+TYPED_TEST(MultiReadMutationScorerTest, SeededRefillsMatchUnseeded)
+{
+    Rng rng(7);
+    std::string tpl = RandomSequence(rng, 300);
+    QuiverConfigTable seededConfigs;
+    seededConfigs.InsertDefault(QuiverConfig(TestingParams(), ALL_MOVES, BandingOptions(4, 200),
+                                             -500, 1.0f, RecursorConfig(5, 0.2f, 0.04f, true)));
+    MMS unseeded(this->testingConfigs_, tpl);
+    MMS seeded(seededConfigs, tpl);
+    for (int n = 0; n < 4; n++) {
+        int tStart = 50 * n;
+        int tEnd = tStart + 100;
+        StrandEnum strand = (n % 2 == 0) ? FORWARD_STRAND : REVERSE_STRAND;
+        std::string window = tpl.substr(tStart, tEnd - tStart);
+        if (strand == REVERSE_STRAND) window = ReverseComplement(window);
+        MappedRead mr = AnonymousMappedRead(window, strand, tStart, tEnd);
+        unseeded.AddRead(mr);
+        seeded.AddRead(mr);
+    }
+
+    for (int pos = 20; pos < 280; pos += 37) {
+        std::vector<Mutation> muts;
+        muts += (pos % 2 == 0) ? Mutation(INSERTION, pos, 'G') : Mutation(DELETION, pos, '-');
+        unseeded.ApplyMutations(muts);
+        seeded.ApplyMutations(muts);
+        ASSERT_EQ(unseeded.Template(), seeded.Template());
+
+        std::vector<float> expected = unseeded.BaselineScores();
+        std::vector<float> scores = seeded.BaselineScores();
+        ASSERT_EQ(expected.size(), scores.size());
+        for (size_t k = 0; k < scores.size(); k++) {
+            EXPECT_NEAR(expected[k], scores[k], 1e-3f);
+        }
+    }
+}
@@ -7,6 +7,7 @@
 
 #include <ConsensusCore/Features.hpp>
 #include <ConsensusCore/Mutation.hpp>
+#include <ConsensusCore/Quiver/BandSeed.hpp>
 #include <ConsensusCore/Quiver/MutationScorer.hpp>
 #include <ConsensusCore/Quiver/QuiverConfig.hpp>
 #include <ConsensusCore/Quiver/QvEvaluator.hpp>
@@ -178,6 +179,29 @@ TYPED_TEST(MutationScorerTest, TemplateMutationWorkflow)
     EXPECT_EQ("GATTAACA", ms.Template());
 }
 
+TYPED_TEST(MutationScorerTest, SeededTemplateMatchesUnseeded)
+{
+    //                 0123456789012345678901234567890
+    std::string tpl = "GATTACAGATTACAGGCTTCAGATTACAGAT";
+    Read read = AnonymousRead("GATTACAGATACAGGCTTTCAGATTACAGAT");
+    E ev(read, tpl, params, true, true);
+    MS ms(ev, recursor);
+
+    std::vector<Mutation> mutations;
+    mutations += Mutation(INSERTION, 10, 'T'), Mutation(SUBSTITUTION, 17, 'T'),
+        Mutation(DELETION, 24, '-');
+    std::string newTpl = ApplyMutations(mutations, tpl);
+    std::vector<int> mtp = TargetToQueryPositions(mutations, tpl);
+    std::vector<Interval> seed = RemapBandSeed(*ms.Alpha(), mtp, newTpl.length() + 1);
+    ASSERT_EQ(newTpl.length() + 1, seed.size());
+
+    ms.Template(newTpl, seed);
+    E freshEv(read, newTpl, params, true, true);
+    MS fresh(freshEv, recursor);
+    EXPECT_EQ(newTpl, ms.Template());
+    EXPECT_FLOAT_EQ(fresh.Score(), ms.Score());
+}
+
 TYPED_TEST(MutationScorerTest, DinucleotideInsertionTest)
 {
     //                     0123456789012345678
@@ -229,3 +253,26 @@ TYPED_TEST(MutationScorerTest, DinucleotideDeletionTest)
     SparseSimpleQvMutationScorer ms2(e2, r2);
     EXPECT_EQ(scoreTT, ms2.ScoreMutation(Mutation(DELETION, 7, 9, "")));
 }
+
+TEST(RecursorConfigTest, RebandingThresholdForcesFlipFlops)
+{
+    // Long enough that the band is a small part of the matrix
+    std::string tpl;
+    for (int n = 0; n < 40; n++) {
+        tpl += "GATTACAGGCTTCAG";
+    }
+    Read read = AnonymousRead(tpl);
+    QuiverConfig quiverConfig = TestingConfig();
+    QvEvaluator ev(read, tpl, quiverConfig.QvParams, true, true);
+    BandingOptions tightBanding(4, 10);
+
+    // A tight band stays under the default threshold...
+    SparseSseQvRecursor defaultRecursor(quiverConfig.MovesAvailable, tightBanding,
+                                        RecursorConfig());
+    EXPECT_GT(3, SparseSseQvMutationScorer(ev, defaultRecursor).NumFlipFlops());
+
+    // ...but never under a zero one
+    SparseSseQvRecursor eagerRecursor(quiverConfig.MovesAvailable, tightBanding,
+                                      RecursorConfig(5, 0.2f, 0.0f));
+    EXPECT_LE(3, SparseSseQvMutationScorer(ev, eagerRecursor).NumFlipFlops());
+}
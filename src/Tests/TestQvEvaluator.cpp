@@ -89,6 +89,68 @@ TEST_F(QvEvaluatorTest, MergeVsMerge4)
     }
 }
 
+// The precomputed score tables must agree with the model formulas, both
+// before and after the template is swapped out from under them.
+TEST(QvEvaluatorTableTest, ScoresMatchModelFormulas)
+{
+    Rng rng(42);
+    QvModelParams p = TestingParams();
+
+    for (int n = 0; n < 50; n++) {
+        std::string tpl = RandomSequence(rng, 20);
+        int I = RandomPoissonDraw(rng, 20);
+        std::string seq = RandomSequence(rng, I);
+        float* insQv = RandomQvArray(rng, I);
+        float* subsQv = RandomQvArray(rng, I);
+        float* delQv = RandomQvArray(rng, I);
+        float* delTag = RandomTagArray(rng, I);
+        float* mergeQv = RandomQvArray(rng, I);
+        QvSequenceFeatures f(seq, insQv, subsQv, delQv, delTag, mergeQv);
+        bool pinStart = RandomBernoulliDraw(rng, 0.5);
+        bool pinEnd = RandomBernoulliDraw(rng, 0.5);
+        QvEvaluator e(Read(f, "anonymous", "unknown"), tpl, p, pinStart, pinEnd);
+
+        for (int swap = 0; swap < 2; swap++) {
+            if (swap) {
+                tpl = RandomSequence(rng, 25);
+                e.Template(tpl);
+            }
+            int J = e.TemplateLength();
+            for (int j = 0; j < J; j++) {
+                for (int i = 0; i <= I; i++) {
+                    float del = p.DeletionN;
+                    if ((!pinStart && i == 0) || (!pinEnd && i == I)) {
+                        del = 0.0f;
+                    } else if (i < I && tpl[j] == delTag[i]) {
+                        del = p.DeletionWithTag + p.DeletionWithTagS * delQv[i];
+                    }
+                    EXPECT_EQ(del, e.Del(i, j));
+                    if (i == I) continue;
+
+                    EXPECT_EQ(seq[i] == tpl[j] ? p.Match : p.Mismatch + p.MismatchS * subsQv[i],
+                              e.Inc(i, j));
+                    EXPECT_EQ(seq[i] == tpl[j] ? p.Branch + p.BranchS * insQv[i]
+                                               : p.Nce + p.NceS * insQv[i],
+                              e.Extra(i, j));
+                    if (j < J - 1) {
+                        int b = encodeTplBase(tpl[j]);
+                        float merge = (seq[i] == tpl[j] && seq[i] == tpl[j + 1])
+                                          ? p.Merge[b] + p.MergeS[b] * mergeQv[i]
+                                          : -FLT_MAX;
+                        EXPECT_EQ(merge, e.Merge(i, j));
+                    }
+                }
+            }
+        }
+
+        delete[] insQv;
+        delete[] subsQv;
+        delete[] delQv;
+        delete[] delTag;
+        delete[] mergeQv;
+    }
+}
+
 TEST_F(QvEvaluatorTest, BadTagTest)
 {
     Rng rng(42);
@@ -9,6 +9,7 @@
 
 #include <ConsensusCore/Align/PairwiseAlignment.hpp>
 #include <ConsensusCore/Features.hpp>
+#include <ConsensusCore/Matrix/CompactSparseMatrix.hpp>
 #include <ConsensusCore/Matrix/DenseMatrix.hpp>
 #include <ConsensusCore/Matrix/SparseMatrix.hpp>
 #include <ConsensusCore/Quiver/QuiverConfig.hpp>
@@ -372,3 +373,128 @@ TYPED_TEST(RecursorFuzzTest, ExtendBeta)
         }
     }
 }
+
+// ----------------------------------------------------------------------------
+// Cross-implementation checks --- fill the same evaluator with two recursors
+// and compare the total scores.
+// ----------------------------------------------------------------------------
+
+template <typename R, typename Reference>
+static void CheckFillsAgree(const R& recursor, const Reference& reference, const QvEvaluator& e,
+                            float tolerance)
+{
+    typedef typename R::MatrixType Matrix;
+    typedef typename Reference::MatrixType RefMatrix;
+    int I = e.ReadLength();
+    int J = e.TemplateLength();
+
+    RefMatrix refAlpha(I + 1, J + 1), refBeta(I + 1, J + 1);
+    reference.FillAlphaBeta(e, refAlpha, refBeta);
+
+    Matrix alpha(I + 1, J + 1), beta(I + 1, J + 1);
+    recursor.FillAlphaBeta(e, alpha, beta);
+    ASSERT_NEAR(refAlpha(I, J), alpha(I, J), tolerance);
+    ASSERT_NEAR(refBeta(0, 0), beta(0, 0), tolerance);
+    ASSERT_NEAR(alpha(I, J), beta(0, 0), tolerance);
+}
+
+// ----------------------------------------------------------------------------
+// SIMD dispatch --- the AVX2/AVX-512 fill kernels must agree with the SSE
+// kernels.  Levels the host CPU lacks are clamped to what it has, so these
+// tests exercise every level available on the machine running them.
+// ----------------------------------------------------------------------------
+
+template <typename R>
+static void CheckSimdLevelsAgree(const BandingOptions& banding, float tolerance, int length = 60,
+                                 int nTrials = 50)
+{
+    const SimdLevel levels[] = {SIMD_AVX2, SIMD_AVX512};
+    R sse(BASIC_MOVES | MERGE, banding, SIMD_SSE);
+
+    Rng rng(42);
+    for (int n = 0; n < nTrials; n++) {
+        QvEvaluator e = RandomNoisyQvEvaluator(rng, length);
+        foreach (SimdLevel level, levels) {
+            SCOPED_TRACE(level);
+            R recursor(BASIC_MOVES | MERGE, banding, level);
+            ASSERT_NO_FATAL_FAILURE(CheckFillsAgree(recursor, sse, e, tolerance));
+        }
+    }
+}
+
+TEST(SimdDispatchTest, DetectedLevel)
+{
+    SimdLevel level = DetectSimdLevel();
+    EXPECT_TRUE(level == SIMD_SSE || level == SIMD_AVX2 || level == SIMD_AVX512);
+
+    BandingOptions banding(4, 200);
+    SseQvRecursor sse(BASIC_MOVES, banding, SIMD_SSE);
+    SseQvRecursor widest(BASIC_MOVES, banding, SIMD_AVX512);
+    SseQvRecursor viterbi(BASIC_MOVES, banding);
+    SparseSseQvSumProductRecursor sumProduct(BASIC_MOVES, banding);
+    EXPECT_EQ(SIMD_SSE, sse.Simd());
+    EXPECT_EQ(level, widest.Simd());
+    EXPECT_EQ(SIMD_SSE, viterbi.Simd());
+    EXPECT_EQ(level, sumProduct.Simd());
+
+    // Only float matrices have wide kernels
+    HalfSseQvRecursor half(BASIC_MOVES, banding, SIMD_AVX512);
+    EXPECT_EQ(SIMD_SSE, half.Simd());
+}
+
+TEST(SimdDispatchTest, ViterbiLevelsAgree)
+{
+    CheckSimdLevelsAgree<SseQvRecursor>(BandingOptions(0, 1e9), 1e-3);
+    CheckSimdLevelsAgree<SparseSseQvRecursor>(BandingOptions(0, 1e9), 1e-3);
+    CheckSimdLevelsAgree<SparseSseQvRecursor>(BandingOptions(4, 200), 1e-3);
+}
+
+TEST(SimdDispatchTest, SumProductLevelsAgree)
+{
+    CheckSimdLevelsAgree<SparseSseQvSumProductRecursor>(BandingOptions(0, 1e9), 1e-2);
+    CheckSimdLevelsAgree<SparseSseQvSumProductRecursor>(BandingOptions(4, 200), 1e-2);
+}
+
+TEST(SimdDispatchTest, NarrowBandOnLongReads)
+{
+    // A tight band on a long read only survives if the wide kernels
+    // terminate each column at the same rows as the SSE kernel.
+    CheckSimdLevelsAgree<SparseSseQvRecursor>(BandingOptions(4, 25), 0.1f, 800, 5);
+    CheckSimdLevelsAgree<SparseSseQvRecursor>(BandingOptions(4, 50), 0.1f, 5000, 2);
+    CheckSimdLevelsAgree<SparseSseQvSumProductRecursor>(BandingOptions(4, 50), 0.1f, 5000, 2);
+}
+
+// ----------------------------------------------------------------------------
+// 16-bit float matrices --- the same kernels over compact storage must track
+// the float scores, out to long reads.
+// ----------------------------------------------------------------------------
+
+template <typename R, typename Reference>
+static void CheckAgainstReference(float tolerance, int length = 40, int nTrials = 100)
+{
+    BandingOptions banding(4, 200);
+    R recursor(BASIC_MOVES | MERGE, banding);
+    Reference reference(BASIC_MOVES | MERGE, banding);
+
+    Rng rng(42);
+    for (int n = 0; n < nTrials; n++) {
+        QvEvaluator e = RandomNoisyQvEvaluator(rng, length);
+        ASSERT_NO_FATAL_FAILURE(CheckFillsAgree(recursor, reference, e, tolerance));
+    }
+}
+
+TEST(CompactMatrixRecursorTest, HalfMatchesFloat)
+{
+    CheckAgainstReference<HalfSseQvRecursor, SparseSseQvRecursor>(0.1f, 100, 50);
+    CheckAgainstReference<HalfSseQvSumProductRecursor, SparseSseQvSumProductRecursor>(0.1f, 100,
+                                                                                      50);
+}
+
+TEST(CompactMatrixRecursorTest, HalfMatchesFloatOnLongReads)
+{
+    // Rounding errors accumulate over the columns of a fill; on a 10 kb
+    // read they must stay inside the alpha/beta mismatch tolerance.
+    CheckAgainstReference<HalfSseQvRecursor, SparseSseQvRecursor>(0.2f, 10000, 2);
+    CheckAgainstReference<HalfSseQvSumProductRecursor, SparseSseQvSumProductRecursor>(0.2f, 10000,
+                                                                                      2);
+}
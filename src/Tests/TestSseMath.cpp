@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+
+#include <ConsensusCore/Quiver/detail/Combiner.hpp>
+#include <ConsensusCore/Quiver/detail/SseMath.hpp>
+
+using namespace ConsensusCore;          // NOLINT
+using namespace ConsensusCore::detail;  // NOLINT
+
+template <typename C>
+class ScanTest : public testing::Test
+{
+};
+
+typedef testing::Types<ViterbiCombiner, SumProductCombiner> Combiners;
+TYPED_TEST_CASE(ScanTest, Combiners);
+
+#define C TypeParam
+
+TYPED_TEST(ScanTest, PrefixScanMatchesCascade)
+{
+    boost::random::mt19937 rng(42);
+    boost::random::uniform_real_distribution<float> score(-100.0f, 0.0f), move(-8.0f, -0.1f);
+
+    for (int n = 0; n < 1000; n++) {
+        float x[4], a[4], expected[4], actual[4];
+        for (int k = 0; k < 4; k++) {
+            x[k] = (n % 7 == k) ? -FLT_MAX : score(rng);
+            a[k] = move(rng);
+        }
+        float carry = (n % 5 == 0) ? -FLT_MAX : score(rng);
+
+        float prev = carry;
+        for (int k = 0; k < 4; k++) {
+            expected[k] = prev = C::Combine(x[k], prev + a[k]);
+        }
+        _mm_storeu_ps(actual, prefixScan4<C>(_mm_loadu_ps(x), _mm_loadu_ps(a), carry));
+
+        for (int k = 0; k < 4; k++) {
+            ASSERT_NEAR(expected[k], actual[k], 1e-4) << "lane " << k;
+        }
+    }
+}
+
+TYPED_TEST(ScanTest, SuffixScanMatchesCascade)
+{
+    boost::random::mt19937 rng(42);
+    boost::random::uniform_real_distribution<float> score(-100.0f, 0.0f), move(-8.0f, -0.1f);
+
+    for (int n = 0; n < 1000; n++) {
+        float x[4], a[4], expected[4], actual[4];
+        for (int k = 0; k < 4; k++) {
+            x[k] = (n % 7 == k) ? -FLT_MAX : score(rng);
+            a[k] = move(rng);
+        }
+        float carry = (n % 5 == 0) ? -FLT_MAX : score(rng);
+
+        float prev = carry;
+        for (int k = 3; k >= 0; k--) {
+            expected[k] = prev = C::Combine(x[k], prev + a[k]);
+        }
+        _mm_storeu_ps(actual, suffixScan4<C>(_mm_loadu_ps(x), _mm_loadu_ps(a), carry));
+
+        for (int k = 0; k < 4; k++) {
+            ASSERT_NEAR(expected[k], actual[k], 1e-4) << "lane " << k;
+        }
+    }
+}
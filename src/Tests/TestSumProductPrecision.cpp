@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include <boost/random/mersenne_twister.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/random/uniform_real_distribution.hpp>
+#include <cfloat>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <ConsensusCore/Edna/EdnaEvaluator.hpp>
+#include <ConsensusCore/Features.hpp>
+#include <ConsensusCore/Matrix/SparseMatrix.hpp>
+#include <ConsensusCore/Quiver/QuiverConfig.hpp>
+#include <ConsensusCore/Quiver/SseRecursor.hpp>
+#include <ConsensusCore/Quiver/detail/SseMath.hpp>
+
+#include "Random.hpp"
+
+using namespace ConsensusCore;  // NOLINT
+
+// ----------------------------------------------------------------------------
+// Precision of the sum-product recursions against double-precision reference
+// values.
+// ----------------------------------------------------------------------------
+
+namespace {
+const double DOUBLE_NEG_INF = -std::numeric_limits<double>::infinity();
+
+double ReferenceLogAdd(double a, double b)
+{
+    if (a == DOUBLE_NEG_INF) return b;
+    if (b == DOUBLE_NEG_INF) return a;
+    double hi = std::max(a, b), lo = std::min(a, b);
+    return hi + std::log1p(std::exp(lo - hi));
+}
+
+double MoveScore(float score)
+{
+    return (score <= -FLT_MAX) ? DOUBLE_NEG_INF : static_cast<double>(score);
+}
+
+// The unbanded forward recursion, in double precision throughout.
+template <typename E>
+double ReferenceScore(const E& e, int movesAvailable)
+{
+    int I = e.ReadLength();
+    int J = e.TemplateLength();
+    std::vector<double> alpha((I + 1) * (J + 1), DOUBLE_NEG_INF);
+
+#define A(i, j) alpha[(j) * (I + 1) + (i)]
+    for (int j = 0; j <= J; j++) {
+        for (int i = 0; i <= I; i++) {
+            double score = (i == 0 && j == 0) ? 0.0 : DOUBLE_NEG_INF;
+            if (i > 0 && j > 0) {
+                score = ReferenceLogAdd(score, A(i - 1, j - 1) + MoveScore(e.Inc(i - 1, j - 1)));
+            }
+            if ((movesAvailable & MERGE) && i > 0 && j > 1) {
+                score = ReferenceLogAdd(score, A(i - 1, j - 2) + MoveScore(e.Merge(i - 1, j - 2)));
+            }
+            if (j > 0) {
+                score = ReferenceLogAdd(score, A(i, j - 1) + MoveScore(e.Del(i, j - 1)));
+            }
+            if (i > 0) {
+                score = ReferenceLogAdd(score, A(i - 1, j) + MoveScore(e.Extra(i - 1, j)));
+            }
+            A(i, j) = score;
+        }
+    }
+    double result = A(I, J);
+#undef A
+    return result;
+}
+
+// The recursor's alpha and beta scores must both track the reference to a
+// relative error that float accumulation over an (I + J)-step path allows.
+template <typename R>
+void CheckAgainstReference(const typename R::EvaluatorType& e, double relativeTolerance)
+{
+    int I = e.ReadLength();
+    int J = e.TemplateLength();
+    int moves = BASIC_MOVES | MERGE;
+
+    R recursor(moves, BandingOptions(0, 1e9));
+    SparseMatrix alpha(I + 1, J + 1), beta(I + 1, J + 1);
+    recursor.FillAlphaBeta(e, alpha, beta);
+
+    double reference = ReferenceScore(e, moves);
+    double tolerance = relativeTolerance * std::max(1.0, std::fabs(reference));
+    EXPECT_NEAR(reference, alpha(I, J), tolerance);
+    EXPECT_NEAR(reference, beta(0, 0), tolerance);
+}
+
+EdnaEvaluator RandomEdnaEvaluator(boost::random::mt19937& rng, int tplLength)
+{
+    boost::random::uniform_int_distribution<> channel(1, 4), errorKind(0, 9);
+
+    std::vector<float> pStay(4, 0.15f), pMerge(4, 0.3f);
+    std::vector<float> moveDists(20), stayDists(20);
+    for (int b = 0; b < 4; b++) {
+        moveDists[5 * b] = 0.05f;
+        stayDists[5 * b] = 0.0f;
+        for (int obs = 1; obs <= 4; obs++) {
+            moveDists[5 * b + obs] = (obs == b + 1) ? 0.8f : 0.05f;
+            stayDists[5 * b + obs] = 0.25f;
+        }
+    }
+    EdnaModelParams params(pStay, pMerge, moveDists, stayDists);
+
+    const char* bases = "ACGT";
+    std::vector<int> channelTpl, channelRead;
+    std::string tpl, read;
+    for (int j = 0; j < tplLength; j++) {
+        channelTpl.push_back(channel(rng));
+        tpl += bases[channelTpl.back() - 1];
+    }
+    for (int j = 0; j < tplLength; j++) {
+        switch (errorKind(rng)) {
+            case 0:  // deletion
+                break;
+            case 1:  // insertion
+                channelRead.push_back(channel(rng));
+                channelRead.push_back(channelTpl[j]);
+                break;
+            case 2:  // substitution
+                channelRead.push_back(channel(rng));
+                break;
+            default:
+                channelRead.push_back(channelTpl[j]);
+        }
+    }
+    for (size_t i = 0; i < channelRead.size(); i++) {
+        read += bases[channelRead[i] - 1];
+    }
+    return EdnaEvaluator(ChannelSequenceFeatures(read, channelRead), tpl, channelTpl, params);
+}
+}
+
+TEST(SumProductPrecisionTest, LogAddCorrectionTerm)
+{
+    // Documented absolute error bounds for the series lengths we support
+    const float bounds[] = {1.5e-5f, 1.5e-6f, 2.5e-7f};
+    float maxError[3] = {0, 0, 0};
+
+    for (double d = -40.0; d <= 0.0; d += 1.0 / 1024) {
+        double reference = std::log1p(std::exp(d));
+        __m128 d4 = _mm_set_ps1(static_cast<float>(d));
+        const float terms[3] = {_mm_cvtss_f32(detail::log1pExp4<4>(d4)),
+                                _mm_cvtss_f32(detail::log1pExp4<5>(d4)),
+                                _mm_cvtss_f32(detail::log1pExp4<6>(d4))};
+        for (int n = 0; n < 3; n++) {
+            double error = std::fabs(static_cast<double>(terms[n]) - reference);
+            maxError[n] = std::max(maxError[n], static_cast<float>(error));
+        }
+    }
+    for (int n = 0; n < 3; n++) {
+        EXPECT_LT(maxError[n], bounds[n]) << (n + 4) << " terms";
+    }
+}
+
+TEST(SumProductPrecisionTest, LogAddEdgeCases)
+{
+    EXPECT_FLOAT_EQ(-10.0f, detail::logAdd(-10.0f, -FLT_MAX));
+    EXPECT_FLOAT_EQ(-FLT_MAX, detail::logAdd(-FLT_MAX, -FLT_MAX));
+    EXPECT_FLOAT_EQ(-5.0f + std::log(2.0f), detail::logAdd(-5.0f, -5.0f));
+
+    float negInf = -std::numeric_limits<float>::infinity();
+    EXPECT_EQ(negInf, detail::logAdd(negInf, negInf));
+}
+
+TEST(SumProductPrecisionTest, QvRecursor)
+{
+    Rng rng(42);
+    for (int n = 0; n < 50; n++) {
+        CheckAgainstReference<SparseSseQvSumProductRecursor>(RandomQvEvaluator(rng, 40), 1e-5);
+    }
+}
+
+TEST(SumProductPrecisionTest, EdnaRecursor)
+{
+    boost::random::mt19937 rng(42);
+    for (int n = 0; n < 50; n++) {
+        CheckAgainstReference<SparseSseEdnaRecursor>(RandomEdnaEvaluator(rng, 40), 1e-5);
+    }
+}